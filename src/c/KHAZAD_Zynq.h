@@ -29,6 +29,28 @@ to run the various applications of the design. The file defines these functions:
 16. compare_blocks
 17. about
 18. performance_measurement (testing mode only)
+19. SW_benchmark
+20. benchmark_report
+21. PRNG_fill
+22. cbcmac_blocks
+23. cbcmac_init
+24. cbcmac_update
+25. cbcmac_final
+26. Zynq_ccm
+27. Zynq_pmac
+28. PL_done_ISR (HAL_DONE_IRQ only)
+29. completion_report
+30. khazad_submit
+31. khazad_poll
+32. khazad_wait
+33. Zynq_crypt_blocks
+34. Zynq_crypt_hybrid
+35. hybrid_report
+36. timer_now
+37. autoselect_calibration
+38. Zynq_crypt_auto
+39. autoselect_report
+40. PL_timeout_ISR (HAL_DONE_IRQ only)
 Identical lines of code may appear in some of functions. This was done to ease the re-use of the functions 
 as standalone programs.
 *********************************************************************************************************
@@ -49,9 +71,28 @@ Version 3.0: ECB & CBC implementation, Hardware & Software
 #include "xil_types.h"
 #include "xstatus.h"
 #include "Xscugic.h"
+#ifdef HAL_DONE_IRQ
+#include "xscutimer.h"
+#endif
 #include "xil_exception.h"
+#include "xtime_l.h"
 #include "nessie_modified.h"
 #include "khazad-tweak32.h"
+#include "khazad-tweak64.h"
+#include "khazad-compact.h"
+#include "khazad-bitslice.h"
+#include "khazad-simd.h"
+#include "khazad-bulk.h"
+#include "khazad-keycache.h"
+#include "khazad-keyagile.h"
+#include "khazad-ctr.h"
+#include "khazad-ccm.h"
+#include "khazad-pmac.h"
+#include "khazad-hal.h"
+#include "khazad-hal-auth.h"
+#include "khazad-queue.h"
+#include "khazad-hybrid.h"
+#include "khazad-autoselect.h"
 
 
 /********************************************************************************************************
@@ -61,13 +102,7 @@ Version 3.0: ECB & CBC implementation, Hardware & Software
 *********************************************************************************************************/
 
 
-// AXI_GPIO modules registers addresses:
-#define ADDR0 ((unsigned int)0x41200000)
-#define ADDR1 ((unsigned int)0x41210000)
-#define ADDR2 ((unsigned int)0x41220000)
-#define ADDR3 ((unsigned int)0x41230000)
-#define ADDR4 ((unsigned int)0x41240000)
-#define ADDR_offset ((unsigned int)0x00000008)
+// the AXI_GPIO modules registers addresses (ADDR0..ADDR5) are defined in khazad-hal.h
 
 // maximal length of input strings, in number of characters, including spaces:
 #define MAX_LENGTH  100
@@ -75,6 +110,35 @@ Version 3.0: ECB & CBC implementation, Hardware & Software
 // number of data blocks for each message in the random vectors test:
 #define BLOCKS_NUM  4
 
+// the PL-to-PS interrupt of the done_IRQ output of controller.v (IRQ_F2P[0]). The version 2.0 PL design
+// (the bitstream in hw/ and sd_image/) has no done_IRQ: define HAL_DONE_IRQ only for a block design which
+// connects it, otherwise the spin-then-sleep completion wait polls (see khazad-hal.h):
+#define PL_DONE_INT_ID  XPS_FPGA0_INT_ID  // = 61
+
+// completion wait modes compared by completion_report (the sleep modes need done_IRQ):
+#ifdef HAL_DONE_IRQ
+#define COMPLETION_MODES  3
+#else
+#define COMPLETION_MODES  1
+#endif
+
+// number of data blocks for each measurement in the software benchmark:
+#define BENCH_BLOCKS  4096
+
+// maximal number of random numbers generated at once by the PRNG application:
+#define PRNG_NUMBERS  64
+
+// incremental CBC-MAC state (cbcmac_init, cbcmac_update, cbcmac_final):
+struct cbcmac_ctx {
+	bool HW;						// 1: the PL design, 0: the software engine
+	struct khazad_hal_ctx session;	// the key and the chaining value (as the IV), for the PL design
+	struct NESSIEstruct subkeys;	// the expanded key, for the software engine
+	u8 chain[BLOCKSIZEB];			// the CBC-MAC of the blocks processed so far
+	u8 partial[BLOCKSIZEB];			// the start of an incomplete data block
+	u32 partial_len;				// number of bytes in partial
+	u64 blocks;						// number of processed data blocks
+};
+
 
 /********************************************************************************************************
 *********************************************************************************************************
@@ -84,16 +148,29 @@ Version 3.0: ECB & CBC implementation, Hardware & Software
 
 
 static XGpioPs my_Gpio; // for the PS
-static XGpio GPIO_4; 	// for the bidirectional module AXI_GPIO_4
+static XGpio GPIO_4; 	// for the bidirectional module AXI_GPIO_4 (data-in only with HAL_SPLIT_DATA)
 static XScuGic my_Gic;  // for GIC: general interrupt controller
-static u16 ctrl;		// for sending instructions to the PL design. Further details in main.c file.
+static struct khazad_hal PL_hal;			// the PL design bus accesses, and the static variable ctrl (PL_hal.ctrl)
+static struct khazad_hal_xilinx PL_xilinx;	// for sending instructions to the PL design. Further details in main.c file.
+#ifdef HAL_DONE_IRQ
+static XScuTimer my_Timer;					// the SCU private timer, which bounds the WFI sleeps of PL_hal
+static volatile u32 PL_interrupts = 0;		// number of done_IRQ interrupts
+static volatile u32 PL_timeouts = 0;		// number of WFI sleeps ended by the timer
+#endif
+static struct khazad_queue PL_queue;		// asynchronous PL jobs (khazad_submit, khazad_poll, khazad_wait)
+static struct khazad_hybrid PL_hybrid;		// the hybrid HW+SW dispatcher (Zynq_crypt_hybrid), and its measured times
+static struct khazad_autoselect PL_select;	// the HW/SW selection table of Zynq_crypt_auto (autoselect_calibration)
 static char *hex = "0123456789ABCDEF"; // for base conversion functions
 // PRNG variables:
-static u32 counter = 0;
+static u64 counter = 0; // the input block is (nonce << 32) + counter
 static u8 nonce[BLOCKSIZEB/2] = {1, 2, 3, 4}; // random value
 static u8 PRNG_key[KEYSIZEB] = {0};			  // random value
 // nonce and PRNG_key are parts of the random stream seed.
 // For cryptographic purposes, this data should be kept secret, and not used twice.
+// software benchmark buffers (static, to keep them off the stack):
+static u8 bench_in [BENCH_BLOCKS*BLOCKSIZEB];
+static u8 bench_ref[BENCH_BLOCKS*BLOCKSIZEB];
+static u8 bench_out[BENCH_BLOCKS*BLOCKSIZEB];
 
 
 /********************************************************************************************************
@@ -121,6 +198,30 @@ void print_data(char *str, u8 *val, int len);
 int compare_blocks(u8 *m1, u8 *m2, int len_bits);
 void about();
 void performance_measurement();
+void SW_benchmark();
+void benchmark_report(char *name, XTime start, XTime end, u32 blocks, u32 keys, u8 *result, u8 *reference);
+void PRNG_fill(u8 * const buf, const u32 len);
+static void cbcmac_blocks(struct cbcmac_ctx * const ctx, const u8 *data, u32 blocks);
+void cbcmac_init(struct cbcmac_ctx * const ctx, const u8 * const key, const bool HW);
+void cbcmac_update(struct cbcmac_ctx * const ctx, const u8 *data, u32 len);
+void cbcmac_final(struct cbcmac_ctx * const ctx, u8 * const mac);
+int Zynq_ccm(const u8 * const text, const u8 * const key, const u8 * const CCM_nonce, const u32 len, const bool enc_dec, u8 * const result, u8 * const tag);
+void Zynq_pmac(const u8 * const text, const u8 * const key, const u32 len, u8 * const tag);
+#ifdef HAL_DONE_IRQ
+static void PL_done_ISR(void *CallBackReff);
+static void PL_timeout_ISR(void *CallBackReff);
+#endif
+void completion_report();
+u32 khazad_submit(const struct khazad_job * const job);
+u32 khazad_poll();
+void khazad_wait(const u32 ticket);
+void Zynq_crypt_blocks(struct khazad_hal_ctx * const ctx, const u8 * const in, u8 * const out, const u32 nblocks, const bool op_mode, const bool enc_dec);
+void Zynq_crypt_hybrid(const struct NESSIEstruct * const subkeys, const struct khazad_hal_ctx * const ctx, const int mode, const u8 * const in, u8 * const out, u8 * const IV, const u32 nblocks);
+void hybrid_report();
+static u64 timer_now();
+void autoselect_calibration();
+void Zynq_crypt_auto(const struct NESSIEstruct * const subkeys, struct khazad_hal_ctx * const ctx, const u8 * const in, u8 * const out, const u32 nblocks, const bool op_mode, const bool enc_dec);
+void autoselect_report();
 
 /********************************************************************************************************
 *********************************************************************************************************
@@ -153,6 +254,10 @@ void board_configuration()
 	xil_printf("AXI_GPIO configuration successful! \n\r");
   else
 	xil_printf("AXI_GPIO configuration failed! \n\r");
+  khazad_hal_xilinx_init(&PL_hal, &PL_xilinx, &GPIO_4, &my_Gpio); // the PL design access layer
+  khazad_queue_init(&PL_queue, &PL_hal); // asynchronous PL jobs
+  khazad_hybrid_init(&PL_hybrid, &PL_hal, timer_now); // hybrid HW+SW dispatcher, calibrated on its first use
+  khazad_autoselect_init(&PL_select, &PL_hal, timer_now); // HW/SW selection, calibrated at startup (autoselect_calibration)
   // Interrupt configuration:
   XScuGic_Config *Gic_Config;
   Gic_Config = XScuGic_LookupConfig(XPAR_PS7_SCUGIC_0_DEVICE_ID);
@@ -172,6 +277,30 @@ void board_configuration()
   XGpioPs_IntrClearPin(&my_Gpio, 51);  // clear any pending residual USR_button interrupts
   XGpioPs_IntrEnablePin(&my_Gpio, 51); // enable USR_button interrupt
   XScuGic_Enable(&my_Gic, XPS_GPIO_INT_ID); // enable GPIO interrupt (SPI: Shared Peripheral Interrupt)
+#ifdef HAL_DONE_IRQ
+  // PL done interrupt, for the spin-then-sleep completion wait (HAL_WAIT_HYBRID). It is left disabled:
+  // PL_hal enables it only while sleeping, so polling doesn't take an interrupt per block:
+  XScuGic_SetPriorityTriggerType(&my_Gic, PL_DONE_INT_ID, 0xA0, 0x3); // priority, rising edge (done_IRQ is a pulse)
+  status = XScuGic_Connect(&my_Gic, PL_DONE_INT_ID, (Xil_ExceptionHandler)PL_done_ISR, (void *)&my_Gic);
+  if (status == XST_SUCCESS)
+  	xil_printf("PL interrupt handler connection successful! \n\r");
+  else
+  	xil_printf("PL interrupt handler connection failed! \n\r");
+  // SCU private timer, which ends a sleep after HAL_SLEEP_TIMEOUT_US if done_IRQ doesn't come:
+  XScuTimer_Config *Timer_Config;
+  Timer_Config = XScuTimer_LookupConfig(XPAR_XSCUTIMER_0_DEVICE_ID);
+  status = XScuTimer_CfgInitialize(&my_Timer, Timer_Config, Timer_Config->BaseAddr);
+  if (status == XST_SUCCESS)
+  	status = XScuGic_Connect(&my_Gic, XPAR_SCUTIMER_INTR, (Xil_ExceptionHandler)PL_timeout_ISR, (void *)&my_Timer);
+  if (status == XST_SUCCESS)
+  {
+  	XScuGic_Enable(&my_Gic, XPAR_SCUTIMER_INTR);
+  	khazad_hal_xilinx_set_irq(&PL_xilinx, &my_Gic, PL_DONE_INT_ID, &my_Timer); // PL_hal may sleep from now on
+  	xil_printf("PL interrupt timer configuration successful! \n\r");
+  }
+  else
+  	xil_printf("PL interrupt timer configuration failed! \n\r");
+#endif
   Xil_ExceptionEnable(); // enable interrupt handling
   XGpioPs_WritePin(&my_Gpio, 47, 1); // turn on the PS-ready indicator LED
 }
@@ -179,7 +308,7 @@ void board_configuration()
 
 /********************************************************************************************************
   2. USR_button_ISR: the user button Interrupt Service Routine.
-  The function communicates with the PL fabric. It makes use of the static variable ctrl 
+  The function communicates with the PL fabric. It makes use of the static variable ctrl (PL_hal.ctrl)
   and configures it to give the appropriate instructions to the design.
 *********************************************************************************************************/
 static void USR_button_ISR(void *CallBackReff)
@@ -187,12 +316,10 @@ static void USR_button_ISR(void *CallBackReff)
   XGpioPs_IntrDisablePin(&my_Gpio, 51); // for debouncing the switch
   XGpioPs_IntrClearPin(&my_Gpio, 51);	// clear the interrupt flag
   XGpioPs_WritePin(&my_Gpio, 47, 0);	// turn off the PS-ready indicator LED
-  ctrl = 0x0020; 		  // reset=1
-  Xil_Out16(ADDR0,ctrl);  // send from PS to FPGA via AXI interface
+  khazad_hal_reset(&PL_hal, 1); // reset=1, send from PS to FPGA via AXI interface
   xil_printf("\t\tFPGA design was reset!\n\r");
   sleep(1); 			  // for debouncing the switch
-  ctrl = 0x0000; 		  // reset=0
-  Xil_Out16(ADDR0,ctrl);
+  khazad_hal_reset(&PL_hal, 0); // reset=0
   XGpioPs_WritePin(&my_Gpio, 47, 1);	// turn on the LED
   XGpioPs_IntrEnablePin(&my_Gpio, 51);
 }
@@ -200,8 +327,12 @@ static void USR_button_ISR(void *CallBackReff)
 
 /********************************************************************************************************
   3. Zynq_crypt: the main function that communicates with the PL fabric and get it to execute 
-  a "crypt" operation: encryption or decryption. The function makes use of the static variable ctrl 
+  a "crypt" operation: encryption or decryption. The function makes use of the static variable ctrl (PL_hal.ctrl)
   and configures it to give the appropriate instructions to the design.
+  The bus accesses go through the hardware access layer (khazad-hal.h), which counts them in PL_hal.stats.
+  The HAL remembers the key and IV loaded in the PL: a new key (only_data = 0) which is already loaded is not sent, 
+  and the operation runs as only_data, without the key schedule (key reload elision); the same for the IV.
+  Jobs submitted by khazad_submit are completed first.
   Function input parameters:
   text: pointer to u8 data-in array.
   key1, key2, key3, key4: four u32 parts of the key.
@@ -216,84 +347,8 @@ static void USR_button_ISR(void *CallBackReff)
 *********************************************************************************************************/
 void Zynq_crypt(const u8 * const text, const u32 key1, const u32 key2, const u32 key3, const u32 key4, const u32 IV1, const u32 IV2, const bool only_data, const bool enc_dec, const bool op_mode, const bool first_block, const bool new_IV, u8 * const result)
 {
-  // map u8-array text to two u32 d_in parts:
-  u32 d_in_1 =
-		((u32)text[0] << 24) ^
-		((u32)text[1] << 16) ^
-		((u32)text[2] <<  8) ^
-		((u32)text[3]      );
-
-  u32 d_in_2 =
-		((u32)text[4] << 24) ^
-		((u32)text[5] << 16) ^
-		((u32)text[6] <<  8) ^
-		((u32)text[7]      );
-
-  if (!only_data)
-  {
-	  // send key:
-	  Xil_Out32(ADDR1,key1)				 ;
-	  Xil_Out32(ADDR1 + ADDR_offset,key2);
-	  Xil_Out32(ADDR2,key3)				 ;
-	  Xil_Out32(ADDR2 + ADDR_offset,key4);
-  }
-
-  if ((op_mode == 1) && (new_IV))
-  {
-	  // send IV:
-	  Xil_Out32(ADDR3,IV1)				;
-	  Xil_Out32(ADDR3 + ADDR_offset,IV2);
-  }
-
-  // set GPIO_4 to output and send data:
-  XGpio_SetDataDirection(&GPIO_4,1,0x00000000);
-  Xil_Out32(ADDR4			   ,d_in_1);
-  Xil_Out32(ADDR4 + ADDR_offset,d_in_2);
-
-  // ctrl setting:
-  ctrl = ctrl ^ 0x0001;   // toggle bit 0, to issue a start command
-  if (first_block == 1)
-    ctrl = ctrl | 0x0002; // = ctrl|000010, turn on bit 1
-  else
-	ctrl = ctrl & 0xFFFD; // = ctrl&111101, turn off bit 1
-  if (op_mode == 1)
-    ctrl = ctrl | 0x0004; // = ctrl|000100, turn on bit 2
-  else
-	ctrl = ctrl & 0xFFFB; // = ctrl&111011, turn off bit 2
-  if (enc_dec == 1)
-    ctrl = ctrl | 0x0008; // = ctrl|001000, turn on bit 3
-  else
-	ctrl = ctrl & 0xFFF7; // = ctrl&110111, turn off bit 3
-  if (only_data == 1)
-    ctrl = ctrl | 0x0010; // = ctrl|010000, turn on bit 4
-  else
-	ctrl = ctrl & 0xFFEF; // = ctrl&101111, turn off bit 4
-
-  Xil_Out16(ADDR0,ctrl);
-  // can't send the start command before both key & data sent because key schedule will end before data has arrived,
-  // and additional flags, and time to send them, will be needed.
-
-  u16 finish;
-  // set GPIO_4 to input and wait for data:
-  XGpio_SetDataDirection(&GPIO_4,1,0xFFFFFFFF);
-  do {
-	  finish = XGpioPs_ReadPin(&my_Gpio, 54); // read from FPGA via EMIO interface (polling)
-  } while ((finish ^ ctrl) & 0x0001); 		  // while LSB of finish != LSB of ctrl
-  // in later version, the EMIO pin is connected to PL_ready, so the condition is: while (!PL_ready)
-
-  // read data from PL via AXI bus:
-  u32 d_out_1 = Xil_In32(ADDR4);
-  u32 d_out_2 = Xil_In32(ADDR4 + ADDR_offset);
-
-  // map two u32 d_out parts to u8-array text:
-  result[0] = (u8)(d_out_1 >> 24);
-  result[1] = (u8)(d_out_1 >> 16);
-  result[2] = (u8)(d_out_1 >>  8);
-  result[3] = (u8)(d_out_1      );
-  result[4] = (u8)(d_out_2 >> 24);
-  result[5] = (u8)(d_out_2 >> 16);
-  result[6] = (u8)(d_out_2 >>  8);
-  result[7] = (u8)(d_out_2      );
+  khazad_wait(PL_queue.submitted); // the PL runs one operation at a time
+  khazad_hal_crypt(&PL_hal, text, key1, key2, key3, key4, IV1, IV2, only_data, enc_dec, op_mode, first_block, new_IV, result);
 }
 
 
@@ -301,92 +356,20 @@ void Zynq_crypt(const u8 * const text, const u32 key1, const u32 key2, const u32
   4. Zynq_crypt_simple: this function is very similar to Zynq_crypt, just more simple (less input parameters), 
   for use in the test vectors operations and in the PRNG.
   The key is given as one parameter, a pointer to u8 array - reflecting the way it's calculated in the test vectors files, 
-  and mapping to four u32 key parts is done inside the function. Also the function lacks the only_data option and the CBC option.
+  and mapping to four u32 key parts is done inside the function. Also the function lacks the only_data option and the CBC option: 
+  every call is a key operation, but the key is sent (and scheduled) only if the PL doesn't hold it already 
+  (key reload elision), so repeated calls with the same key run with only_data.
   One can easily create different versions of this function for other kinds of tests.
 *********************************************************************************************************/
 void Zynq_crypt_simple(const u8 * const text, const u8 * const key, const bool enc_dec, u8 * const result)
 {
-  // map u8-array text to two u32 d_in parts:
-  u32 d_in_1 =
-		((u32)text[0] << 24) ^
-		((u32)text[1] << 16) ^
-		((u32)text[2] <<  8) ^
-		((u32)text[3]      );
-
-  u32 d_in_2 =
-		((u32)text[4] << 24) ^
-		((u32)text[5] << 16) ^
-		((u32)text[6] <<  8) ^
-		((u32)text[7]      );
-
-  // map u8-array key to four u32 key parts:
-  u32 key1 =
-		((u32)key[ 0] << 24) ^
-		((u32)key[ 1] << 16) ^
-		((u32)key[ 2] <<  8) ^
-		((u32)key[ 3]      );
-
-  u32 key2 =
-		((u32)key[ 4] << 24) ^
-		((u32)key[ 5] << 16) ^
-		((u32)key[ 6] <<  8) ^
-		((u32)key[ 7]      );
-
-  u32 key3 =
-		((u32)key[ 8] << 24) ^
-		((u32)key[ 9] << 16) ^
-		((u32)key[10] <<  8) ^
-		((u32)key[11]      );
-
-  u32 key4 =
-		((u32)key[12] << 24) ^
-		((u32)key[13] << 16) ^
-		((u32)key[14] <<  8) ^
-		((u32)key[15]      );
-
-  // send key:
-  Xil_Out32(ADDR1,key1)					;
-  Xil_Out32(ADDR1 + ADDR_offset,key2)	;
-  Xil_Out32(ADDR2,key3)					;
-  Xil_Out32(ADDR2 + ADDR_offset,key4)	;
-  // set GPIO_4 to output and send data:
-  XGpio_SetDataDirection(&GPIO_4,1,0x00000000);
-  Xil_Out32(ADDR4			   ,d_in_1)	;
-  Xil_Out32(ADDR4 + ADDR_offset,d_in_2)	;
-
-  // ctrl setting:
-  ctrl = ctrl ^ 0x0001;   // toggle bit 0, to issue a start command
-  if (enc_dec == 1)
-    ctrl = ctrl | 0x0008; // = ctrl|001000, turn on bit 3
-  else
-	ctrl = ctrl & 0xFFF7; // = ctrl&110111, turn off bit 3
-  ctrl = ctrl & 0xFFE9;   // = ctrl&101001, turn off bits 4,2,1. only_data and CBC mode are inactive
+  struct khazad_hal_ctx ctx;
 
-  Xil_Out16(ADDR0,ctrl);
-  // can't send the start command before both key & data sent because key schedule will end before data has arrived,
-  // and additional flags, and time to send them, will be needed.
+  khazad_hal_ctx_init(&ctx, key, NULL);  // map u8-array key to four u32 key parts
 
-  u16 finish;
-  // set GPIO_4 to input and wait for data:
-  XGpio_SetDataDirection(&GPIO_4,1,0xFFFFFFFF);
-  do {
-	  finish = XGpioPs_ReadPin(&my_Gpio, 54); // read from FPGA via EMIO interface (polling)
-  } while ((finish ^ ctrl) & 0x0001);		  // while LSB of finish != LSB of ctrl
-  // in later version, the EMIO pin is connected to PL_ready, so the condition is: while (!PL_ready)
-
-  // read data from PL via AXI bus:
-  u32 d_out_1 = Xil_In32(ADDR4);
-  u32 d_out_2 = Xil_In32(ADDR4 + ADDR_offset);
-  
-  // map two u32 d_out parts to u8-array text:
-  result[0] = (u8)(d_out_1 >> 24);
-  result[1] = (u8)(d_out_1 >> 16);
-  result[2] = (u8)(d_out_1 >>  8);
-  result[3] = (u8)(d_out_1      );
-  result[4] = (u8)(d_out_2 >> 24);
-  result[5] = (u8)(d_out_2 >> 16);
-  result[6] = (u8)(d_out_2 >>  8);
-  result[7] = (u8)(d_out_2      );
+  // ECB mode with a new key (elided if loaded):
+  khazad_wait(PL_queue.submitted);
+  khazad_hal_crypt(&PL_hal, text, ctx.key[0], ctx.key[1], ctx.key[2], ctx.key[3], 0, 0, 0, enc_dec, 0, 0, 0, result);
 }
 
 
@@ -397,10 +380,13 @@ void Zynq_crypt_simple(const u8 * const text, const u8 * const key, const bool e
   The original test includes a stage of 10^8 iterations, so it may take some time to be completed.
   We have added an option for shortened test, in which this stage was shortened into 10^6 iterations.
   We recommend to use this option if time is short.
+  Sets 1 and 3 iterate with the same key (except the last stage of set 3), and set 2 uses one key for all 
+  its vectors, so most of the PL key schedules are elided (Zynq_crypt_simple); their number is printed at the end.
 *********************************************************************************************************/
 void test_vectors()
 {
   struct NESSIEstruct subkeys;
+  struct keycache_stats cache_stats;
   bool valid_answer = 0;
   u8 answer;
   u8 key[KEYSIZEB];
@@ -430,6 +416,7 @@ void test_vectors()
 	} while (!valid_answer);
 
   XGpioPs_WritePin(&my_Gpio, 47, 0);	// turn off the PS-ready indicator LED
+  khazad_hal_clear_stats(&PL_hal);
 
   xil_printf("Test vectors -- set 1\n");
   xil_printf("=====================\n\n");
@@ -628,11 +615,12 @@ void test_vectors()
       print_data("key", key, KEYSIZEB);
       print_data("plain", plain, BLOCKSIZEB);
 
+      // the keys are a single repeated byte, so there are only 256 different key schedules:
+      // the key setup is replaced by a lookup in the key schedule cache
       for(i=0; i<iterations; i++)
         {
           memset(key, cipher[BLOCKSIZEB-1], KEYSIZEB);
-          NESSIEkeysetup(key, &subkeys);
-          NESSIEencrypt(&subkeys, cipher, cipher);
+          keycache_encrypt(keycache_lookup(key), cipher, cipher);
         }
 	  if (iterations == 999999)
 	    print_data("Iterated 10^6 times", cipher, BLOCKSIZEB);
@@ -654,6 +642,10 @@ void test_vectors()
       xil_printf("\n");
     }
 
+  cache_stats = keycache_statistics();
+  xil_printf("Key schedule cache: %u hits, %u misses, %u evictions \n", cache_stats.hits, cache_stats.misses, cache_stats.evictions);
+  xil_printf("PL key schedules: %u, elided key reloads: %u \n", PL_hal.stats.keys, PL_hal.stats.keys_elided);
+
   xil_printf("\n\nEnd of test vectors\n");
 
   XGpioPs_WritePin(&my_Gpio, 47, 1);	// turn on the PS-ready indicator LED
@@ -665,16 +657,15 @@ void test_vectors()
   It prompts the user for key and for plaintext string data, then processes the data block-by-block.
   Each block is encrypted and then decrypted, first by using the reference code, 
   then by using the Zynq hardware implementation.
-  Since the function works block-by-block and switches between encryption and decryption, 
-  only ECB mode can be used.
+  Since the blocks are compared one by one, only ECB mode is used.
   For each block the plaintext, the reference code ciphertext, the reference code decrypted text, the Zynq ciphertext, 
   the Zynq decrypted text (all five in hexadecimal ASCII code) and the block number are printed on screen.
   Comparisons are made for each block between the reference code ciphertext and the Zynq ciphertext, 
   and between the plaintext and the Zynq decrypted text, 
   and also between the original characters string and a decrypted re-calculated string.
   If a comparison fails, an error massage appears.
-  The demonstration calls the Zynq_crypt full version function, 
-  and uses the only_data option whenever possible.
+  The demonstration calls the Zynq_crypt_blocks function: the whole zero padded string is encrypted by one call, 
+  and the ciphertext is decrypted by another, with the key sent once per call and only_data for the other blocks.
 *********************************************************************************************************/
 void demonstration()
 {
@@ -682,7 +673,9 @@ void demonstration()
   u8 key[KEYSIZEB];
   struct NESSIEstruct subkeys;
   bool valid_answer, go = 1;
-  u8 answer, data_string[MAX_LENGTH+1], decrypted_string[MAX_LENGTH+1], plain[BLOCKSIZEB], cipher[BLOCKSIZEB], decrypted[BLOCKSIZEB], Zynq_cipher[BLOCKSIZEB], Zynq_decrypted[BLOCKSIZEB];
+  u8 answer, data_string[MAX_LENGTH+1], decrypted_string[MAX_LENGTH+1], cipher[BLOCKSIZEB], decrypted[BLOCKSIZEB];
+  u8 plain[MAX_LENGTH+BLOCKSIZEB], Zynq_cipher[MAX_LENGTH+BLOCKSIZEB], Zynq_decrypted[MAX_LENGTH+BLOCKSIZEB];  // whole data blocks
+  struct khazad_hal_ctx ctx;
 
   xil_printf("*************************************************************** \n\r");
   xil_printf("Secret key configuration: \nKHAZAD is using a 128-bit key (32 figures in hexadecimal base). \n");
@@ -722,51 +715,36 @@ void demonstration()
 
 	  XGpioPs_WritePin(&my_Gpio, 47, 0);	// turn off the PS-ready indicator LED
 
-	  u16 i = 0, j = 0, k = 0, block_num = 0;
-	  while (data_string[i])
-	  {
-		  if (j < BLOCKSIZEB)
-		  {
-			  memset(plain+j, data_string[i], 1);
-			  j++;
-		  }
+	  // zero padded data blocks:
+	  u16 i = strlen((char *)data_string), k, block_num = (i + BLOCKSIZEB - 1)/BLOCKSIZEB;
+	  memset(plain, 0, sizeof(plain));
+	  memcpy(plain, data_string, i);
 
-		  if ((j != BLOCKSIZEB) && !(data_string[i+1])) // residue exists
-			  memset(plain+j, 0, BLOCKSIZEB-j); 		// zero padding
+	  // Zynq HW encryption & decryption of all the blocks:
+	  khazad_hal_ctx_init(&ctx, key, NULL);
+	  Zynq_crypt_blocks(&ctx, plain, Zynq_cipher, block_num, 0, 1);  		// op_mode = 0 (ECB). enc_dec = 1.
+	  Zynq_crypt_blocks(&ctx, Zynq_cipher, Zynq_decrypted, block_num, 0, 0); // op_mode = 0 (ECB). enc_dec = 0.
 
-		  if (((j != BLOCKSIZEB) && !(data_string[i+1])) || (j == BLOCKSIZEB)) // need to encrypt
-		  {
-			  // reference code SW encryption & decryption:
-			  NESSIEencrypt(&subkeys, plain, cipher);
-			  NESSIEdecrypt(&subkeys, cipher, decrypted);
-			  xil_printf("\n Text block number %u: \n", block_num+1);
-			  print_data("plaintext", plain, BLOCKSIZEB);
-			  print_data("SW ciphertext", cipher, BLOCKSIZEB);
-			  print_data("SW decrypted text", decrypted, BLOCKSIZEB);
-
-			  // Zynq HW encryption & decryption:
-			  if (block_num == 0)
-				Zynq_crypt(plain, key1, key2, key3, key4, 0, 0, 0, 1, 0, 0, 0, Zynq_cipher);   // first operation: only_data = 0. enc_dec = 1.
-			  else
-				Zynq_crypt(plain, key1, key2, key3, key4, 0, 0, 1, 1, 0, 0, 0, Zynq_cipher);   // not first operation: only_data = 1. enc_dec = 1.
-			  Zynq_crypt(Zynq_cipher, key1, key2, key3, key4, 0, 0, 1, 0, 0, 0, 0, Zynq_decrypted); // not first operation: only_data = 1. enc_dec = 0.
-			  print_data("HW ciphertext", Zynq_cipher, BLOCKSIZEB);
-			  print_data("HW decrypted text", Zynq_decrypted, BLOCKSIZEB);
-
-			  if(compare_blocks(cipher, Zynq_cipher, BLOCKSIZE) != 0)
-			    xil_printf("** HW encryption error: **\n    Ciphertext from Zynq is different than the reference code cipher!\n");
-
-			  if(compare_blocks(plain, Zynq_decrypted, BLOCKSIZE) != 0)
-			    xil_printf("** HW decryption error: **\n    Decrypted ciphertext on Zynq is different than the plaintext!\n");
-
-			  for (k = 0; k < j; k++)
-				decrypted_string[block_num*BLOCKSIZEB + k] = Zynq_decrypted[k];
-			  block_num++;
-			  j = 0;
-		  }
-		  i++;
+	  for (k = 0; k < block_num; k++)
+	  {
+		  // reference code SW encryption & decryption:
+		  NESSIEencrypt(&subkeys, plain + k*BLOCKSIZEB, cipher);
+		  NESSIEdecrypt(&subkeys, cipher, decrypted);
+		  xil_printf("\n Text block number %u: \n", k+1);
+		  print_data("plaintext", plain + k*BLOCKSIZEB, BLOCKSIZEB);
+		  print_data("SW ciphertext", cipher, BLOCKSIZEB);
+		  print_data("SW decrypted text", decrypted, BLOCKSIZEB);
+		  print_data("HW ciphertext", Zynq_cipher + k*BLOCKSIZEB, BLOCKSIZEB);
+		  print_data("HW decrypted text", Zynq_decrypted + k*BLOCKSIZEB, BLOCKSIZEB);
+
+		  if(compare_blocks(cipher, Zynq_cipher + k*BLOCKSIZEB, BLOCKSIZE) != 0)
+		    xil_printf("** HW encryption error: **\n    Ciphertext from Zynq is different than the reference code cipher!\n");
+
+		  if(compare_blocks(plain + k*BLOCKSIZEB, Zynq_decrypted + k*BLOCKSIZEB, BLOCKSIZE) != 0)
+		    xil_printf("** HW decryption error: **\n    Decrypted ciphertext on Zynq is different than the plaintext!\n");
 	  }
 
+	  memcpy(decrypted_string, Zynq_decrypted, i);
 	  decrypted_string[i] = 0; // NULL character to end decrypted_string
 	  xil_printf("\nThe original string is: %s \n\r", data_string);
 	  xil_printf("The decrypted string from Zynq HW implementation is: %s \n\r", decrypted_string);
@@ -805,19 +783,19 @@ void demonstration()
   and the ciphertext is calculated and printed on screen as hexadecimal figures.
   For decryption, a ciphertext hexadecimal figures string is entered, 
   and the plaintext is calculated and printed on screen as regular characters.
+  The zero padded data blocks are processed by one Zynq_crypt_blocks call.
 *********************************************************************************************************/
 void HW_application()
 {
   u32 key1 = 0, key2 = 0, key3 = 0, key4 = 0, IV1 = 0, IV2 = 0;
-  bool enc_dec, only_data, op_mode, first_block, new_IV, valid_answer, key_entered, IV_entered, first_run = 1, CBC_first_run = 1, go = 1;
-  u8 answer, data_in_string[MAX_LENGTH+1], cipher_in_string[2*MAX_LENGTH+1], block_in[BLOCKSIZEB], block_out[BLOCKSIZEB+1];
+  bool enc_dec, op_mode, valid_answer, first_run = 1, CBC_first_run = 1, go = 1;
+  u8 answer, data_in_string[MAX_LENGTH+BLOCKSIZEB], cipher_in_string[2*MAX_LENGTH+1], data_out[MAX_LENGTH+BLOCKSIZEB+1];
+  struct khazad_hal_ctx ctx;
   char temp[2];
 
   xil_printf("*************************************************************** \n\r");
   while (go)
   {
-	key_entered = 0;
-	IV_entered = 0;
 	valid_answer = 0;
 	do {
 		xil_printf("For encryption, please press 'e'.  For decryption, please press 'd'. \n\r");
@@ -885,7 +863,6 @@ void HW_application()
 		scanf("%x", &key3);
 		xil_printf("Please enter key part number 4 \n\r");
 		scanf("%x", &key4);
-		key_entered = 1;
 	}
 	xil_printf("key= %08X%08X%08X%08X \n\r", key1, key2, key3, key4);
 
@@ -912,7 +889,6 @@ void HW_application()
 		scanf("%x", &IV1);
 		xil_printf("Please enter IV part number 2 \n");
 		scanf("%x", &IV2);
-		IV_entered = 1;
 	}
 	
 	if (op_mode == 1)
@@ -942,51 +918,23 @@ void HW_application()
 
 	XGpioPs_WritePin(&my_Gpio, 47, 0);	// turn off the PS-ready indicator LED
 
-	block_out[BLOCKSIZEB] = 0;    // NULL character to end the string
-	i = 0;
-	u16 j = 0, k = 0, block_num = 0;
-	while (data_in_string[i])
-	{
-		if (j < BLOCKSIZEB)
-		{
-			memset(block_in+j, data_in_string[i], 1);
-			j++;
-		}
+	// zero padded data blocks:
+	u16 length = strlen((char *)data_in_string), block_num = (length + BLOCKSIZEB - 1)/BLOCKSIZEB, k;
+	memset(data_in_string + length, 0, sizeof(data_in_string) - length);
 
-		if ((j != BLOCKSIZEB) && !(data_in_string[i+1])) // residue exists
-			memset(block_in+j, 0, BLOCKSIZEB-j); 		 // zero padding
-
-		if (((j != BLOCKSIZEB) && !(data_in_string[i+1])) || (j == BLOCKSIZEB)) // need to encrypt/decrypt
+	ctx.key[0] = key1; ctx.key[1] = key2; ctx.key[2] = key3; ctx.key[3] = key4;
+	ctx.IV[0] = IV1; ctx.IV[1] = IV2;
+	Zynq_crypt_blocks(&ctx, data_in_string, data_out, block_num, op_mode, enc_dec);
+	if (enc_dec == 1)
+		for (k=0; k < block_num*BLOCKSIZEB; k++) // ciphertext output: print as hexadecimal figures
 		{
-			if (block_num == 0)
-				first_block = 1;
-			else
-				first_block = 0;
-
-			if ((block_num == 0) && (key_entered == 1))
-				only_data = 0;
-			else
-				only_data = 1;
-
-			if ((block_num == 0) && (IV_entered == 1))
-				new_IV = 1;
-			else
-				new_IV = 0;
-
-			Zynq_crypt(block_in, key1, key2, key3, key4, IV1, IV2, only_data, enc_dec, op_mode, first_block, new_IV, block_out);
-			if (enc_dec == 1)
-				for (k=0; k < BLOCKSIZEB; k++) // ciphertext output: print as hexadecimal figures
-				{
-					putchar(hex[(block_out[k]>>4)&0xF]);
-					putchar(hex[(block_out[k]   )&0xF]);
-				}
-			else
-				xil_printf("%s", block_out);       // plaintext output: print as characters
-
-			block_num++;
-			j = 0;
+			putchar(hex[(data_out[k]>>4)&0xF]);
+			putchar(hex[(data_out[k]   )&0xF]);
 		}
-		i++;
+	else
+	{
+		data_out[block_num*BLOCKSIZEB] = 0;  // NULL character to end the string
+		xil_printf("%s", data_out);          // plaintext output: print as characters
 	}
 
 	first_run = 0;
@@ -1297,21 +1245,21 @@ void SW_application()
 
 /********************************************************************************************************
   11. CBC_MAC (Message Authentication Code): 
-  this function is similar to the HW_application function, and generates a basic CBC-MAC.
+  this function is similar to the HW_application function, and generates a basic CBC-MAC 
+  (zero IV, zero padding) of a message, in HW, using the incremental CBC-MAC functions (cbcmac_init, ...).
 *********************************************************************************************************/
 void CBC_MAC()
 {
-  u32 key1 = 0, key2 = 0, key3 = 0, key4 = 0, IV1 = 0, IV2 = 0;
-  bool only_data, first_block, new_IV, valid_answer, key_entered, first_run = 1, go = 1;
-  u8 answer, data_in_string[MAX_LENGTH+1], block_in[BLOCKSIZEB], block_out[BLOCKSIZEB];
+  u32 key1 = 0, key2 = 0, key3 = 0, key4 = 0, k;
+  bool valid_answer, first_run = 1, go = 1;
+  u8 answer, data_in_string[MAX_LENGTH+1], key[KEYSIZEB], block_out[BLOCKSIZEB];
+  struct cbcmac_ctx ctx;
 
   xil_printf("*************************************************************** \n\r");
   xil_printf("CBC-MAC generator \n");
   xil_printf("using the KHAZAD algorithm \n\r");
   while (go)
   {
-	key_entered = 0;
-
 	if (!first_run)
 	{
 		valid_answer = 0;
@@ -1339,52 +1287,27 @@ void CBC_MAC()
 		scanf("%x", &key3);
 		xil_printf("Please enter key part number 4 \n\r");
 		scanf("%x", &key4);
-		key_entered = 1;
 	}
 	xil_printf("key= %08X%08X%08X%08X \n\r", key1, key2, key3, key4);
-	xil_printf("IV= %08X%08X \n", IV1, IV2);
+	xil_printf("IV= %08X%08X \n", 0, 0);
+
+	// map four u32 key parts to u8-array key:
+	for (k=0; k < 4; k++)
+	{
+		key[k   ] = (u8)(key1 >> (24 - 8*k));
+		key[k+ 4] = (u8)(key2 >> (24 - 8*k));
+		key[k+ 8] = (u8)(key3 >> (24 - 8*k));
+		key[k+12] = (u8)(key4 >> (24 - 8*k));
+	}
 
 	xil_printf("\nPlease enter a message (up to %d characters, including spaces) \n", MAX_LENGTH);
 	scanf(" %[^\r]s", data_in_string);  // scanf format to allow reading spaces
 
 	XGpioPs_WritePin(&my_Gpio, 47, 0);	// turn off the PS-ready indicator LED
 
-	u16 i = 0, j = 0, k = 0, block_num = 0;
-	while (data_in_string[i])
-	{
-		if (j < BLOCKSIZEB)
-		{
-			memset(block_in+j, data_in_string[i], 1);
-			j++;
-		}
-
-		if ((j != BLOCKSIZEB) && !(data_in_string[i+1])) // residue exists
-			memset(block_in+j, 0, BLOCKSIZEB-j); 		 // zero padding
-
-		if (((j != BLOCKSIZEB) && !(data_in_string[i+1])) || (j == BLOCKSIZEB)) // need to encrypt
-		{
-			if (block_num == 0)
-				first_block = 1;
-			else
-				first_block = 0;
-
-			if ((block_num == 0) && (key_entered == 1))
-				only_data = 0;
-			else
-				only_data = 1;
-
-			if ((block_num == 0) && (first_run == 1))
-				new_IV = 1;
-			else
-				new_IV = 0;
-
-			Zynq_crypt(block_in, key1, key2, key3, key4, IV1, IV2, only_data, 1, 1, first_block, new_IV, block_out); // enc_dec=1, op_mode=1
-
-			block_num++;
-			j = 0;
-		}
-		i++;
-	}
+	cbcmac_init(&ctx, key, 1);	// HW=1
+	cbcmac_update(&ctx, data_in_string, strlen((char *)data_in_string));
+	cbcmac_final(&ctx, block_out);
 
 	xil_printf("\n\t CBC-MAC: \n");
 	for (k=0; k < BLOCKSIZEB; k++) // print as hexadecimal figures
@@ -1421,22 +1344,24 @@ void CBC_MAC()
   this function makes use of the KHAZAD algorithm HW implementation to generate 64-bit cryptographically secure pseudo-random numbers.
   It implements the CTR mode of operation principle: 
   the first half of the input data block is a fixed nonce value, and the second half is a running counter.
-  It uses a fixed key value, and the Zynq_crypt_simple function.
+  The counter is 64-bit long and is added to the nonce (nonce << 32), so after 2^32 numbers it carries into the nonce half.
+  It uses a fixed key value, and the Zynq_crypt_simple function, so the key is scheduled in the PL only once 
+  (unless another key was loaded since the last call).
   The nonce and the key were chosen randomly, and one can easily replace them with new values.
   For a given set of values, the PRNG is deterministic.
+  For many random numbers at once, PRNG_fill is much faster (the key is sent only once).
 *********************************************************************************************************/
 void PRNG(u8 * const result)
 {
 	u8 input[BLOCKSIZEB];
+	u64 block;
 	u16 i;
-	// get NONCE in the first half of u8-array input:
-    for (i=0; i < BLOCKSIZEB/2; i++)
-	  input[i] = nonce[i];
-	// map u32 counter to the second half of u8-array input:
-    input[4] = (u8)(counter >> 24);
-    input[5] = (u8)(counter >> 16);
-    input[6] = (u8)(counter >>  8);
-    input[7] = (u8)(counter      );
+	// input block = (nonce << 32) + counter:
+	block = ((u64)nonce[0] << 56) ^ ((u64)nonce[1] << 48) ^ ((u64)nonce[2] << 40) ^ ((u64)nonce[3] << 32);
+	block += counter;
+	// map to u8-array input:
+	for (i=0; i < BLOCKSIZEB; i++)
+	  input[i] = (u8)(block >> (56 - 8*i));
 	Zynq_crypt_simple(input, PRNG_key, 1, result);
 	counter++;
 }
@@ -1457,7 +1382,8 @@ void random_vectors_test()
 	int keys_num, messages_num, errors = 0;
 	u8 key[KEYSIZEB], IV[BLOCKSIZEB], CBC_Xor[BLOCKSIZEB], plain[BLOCKS_NUM][BLOCKSIZEB], cipher[BLOCKS_NUM][BLOCKSIZEB], decrypted[BLOCKS_NUM][BLOCKSIZEB], Zynq_cipher[BLOCKS_NUM][BLOCKSIZEB], Zynq_decrypted[BLOCKS_NUM][BLOCKSIZEB], answer;
 	struct NESSIEstruct subkeys;
-	bool op_mode, only_data, first_block, new_IV = 0, valid_answer;
+	struct khazad_job job;
+	bool op_mode, new_IV = 0, valid_answer;
 
 	xil_printf("*************************************************************** \n\r");
 	xil_printf("Please enter a number of random keys to use \n\r");
@@ -1562,81 +1488,72 @@ void random_vectors_test()
 				printf("  ");
 			}
 
-			only_data = 0;		// for each message re-send key to HW, because PRNG() has changed it
+			// HW encryption and decryption jobs: the PL runs them while the SW results are calculated and printed.
+			// For each message re-send key to HW (only_data=0 for the first block), because PRNG() has changed it.
+			// Each decryption job starts after the encryption job of its input block has completed.
+			job.key1 = key1; job.key2 = key2; job.key3 = key3; job.key4 = key4;
+			job.IV1 = IV1; job.IV2 = IV2;
+			job.op_mode = op_mode;
+			for (k=0; k < 2*BLOCKS_NUM; k++)
+			{
+				job.enc_dec = (k < BLOCKS_NUM);
+				job.text = job.enc_dec ? plain[k] : Zynq_cipher[k - BLOCKS_NUM];
+				job.result = job.enc_dec ? Zynq_cipher[k] : Zynq_decrypted[k - BLOCKS_NUM];
+				job.only_data = (k != 0);
+				job.first_block = (k % BLOCKS_NUM == 0);
+				job.new_IV = (k == 0) && new_IV;
+				khazad_submit(&job);
+			}
+			new_IV = 0;
 
 			printf("\n\nSW ciphertext: \n\r");
 
 			if (op_mode == 0)
-				for (k=0; k < BLOCKS_NUM; k++)
-				{
-					NESSIEencrypt(&subkeys, plain[k], cipher[k]);  				// ECB encryption
-					for (m=0; m < BLOCKSIZEB; m++)
-					{
-						putchar(hex[(cipher[k][m]>>4)&0xF]);
-						putchar(hex[(cipher[k][m]   )&0xF]);
-					}
-					printf("  ");
-				}
+				NESSIEencrypt_blocks(&subkeys, plain[0], cipher[0], BLOCKS_NUM);  // ECB encryption of the whole message
 			else
 			{
 				for (m=0; m < BLOCKSIZEB; m++) // for each message reset CBC_Xor in SW, because last CBC opration has changed it
 					CBC_Xor[m] = IV[m];
 				for (k=0; k < BLOCKS_NUM; k++)
+					NESSIEencrypt_CBC(&subkeys, plain[k], CBC_Xor, cipher[k]);  // CBC encryption (sequential by nature)
+			}
+			for (k=0; k < BLOCKS_NUM; k++)
+			{
+				for (m=0; m < BLOCKSIZEB; m++)
 				{
-					NESSIEencrypt_CBC(&subkeys, plain[k], CBC_Xor, cipher[k]);  // CBC encryption
-					for (m=0; m < BLOCKSIZEB; m++)
-					{
-						putchar(hex[(cipher[k][m]>>4)&0xF]);
-						putchar(hex[(cipher[k][m]   )&0xF]);
-					}
-					printf("  ");
+					putchar(hex[(cipher[k][m]>>4)&0xF]);
+					putchar(hex[(cipher[k][m]   )&0xF]);
 				}
+				printf("  ");
+				khazad_poll(); // keep the PL busy
 			}
 
 			printf("\n\nSW decrypted text: \n\r");
 
 			if (op_mode == 0)
-				for (k=0; k < BLOCKS_NUM; k++)
-				{
-					NESSIEdecrypt(&subkeys, cipher[k], decrypted[k]);  			// ECB decryption
-					for (m=0; m < BLOCKSIZEB; m++)
-					{
-						putchar(hex[(decrypted[k][m]>>4)&0xF]);
-						putchar(hex[(decrypted[k][m]   )&0xF]);
-					}
-					printf("  ");
-				}
+				NESSIEdecrypt_blocks(&subkeys, cipher[0], decrypted[0], BLOCKS_NUM);  // ECB decryption of the whole message
 			else
 			{
 				for (m=0; m < BLOCKSIZEB; m++) // reset CBC_Xor because last CBC opration has changed it
 					CBC_Xor[m] = IV[m];
-				for (k=0; k < BLOCKS_NUM; k++)
+				NESSIEdecrypt_CBC_blocks(&subkeys, cipher[0], CBC_Xor, decrypted[0], BLOCKS_NUM); // CBC decryption of the whole message
+			}
+			for (k=0; k < BLOCKS_NUM; k++)
+			{
+				for (m=0; m < BLOCKSIZEB; m++)
 				{
-					NESSIEdecrypt_CBC(&subkeys, cipher[k], CBC_Xor, decrypted[k]); // CBC decryption
-					for (m=0; m < BLOCKSIZEB; m++)
-					{
-						putchar(hex[(decrypted[k][m]>>4)&0xF]);
-						putchar(hex[(decrypted[k][m]   )&0xF]);
-					}
-					printf("  ");
+					putchar(hex[(decrypted[k][m]>>4)&0xF]);
+					putchar(hex[(decrypted[k][m]   )&0xF]);
 				}
+				printf("  ");
+				khazad_poll();
 			}
 
+			khazad_wait(PL_queue.submitted); // all the HW jobs of the message
+
 			printf("\n\nHW ciphertext: \n\r");
 			for (k=0; k < BLOCKS_NUM; k++)
 			{
-				if (k == 0)
-					first_block = 1;
-				else
-					first_block = 0;
-
-				if (k == 1)
-				{
-					new_IV = 0;
-					only_data = 1;
-				}
-
-				Zynq_crypt(plain[k], key1, key2, key3, key4, IV1, IV2, only_data, 1, op_mode, first_block, new_IV, Zynq_cipher[k]); //enc_dec=1
 				for (m=0; m < BLOCKSIZEB; m++)
 				{
 					putchar(hex[(Zynq_cipher[k][m]>>4)&0xF]);
@@ -1648,12 +1565,6 @@ void random_vectors_test()
 			printf("\n\nHW decrypted text: \n\r");
 			for (k=0; k < BLOCKS_NUM; k++)
 			{
-				if (k == 0)
-					first_block = 1;
-				else
-					first_block = 0;
-
-				Zynq_crypt(Zynq_cipher[k], key1, key2, key3, key4, IV1, IV2, only_data, 0, op_mode, first_block, new_IV, Zynq_decrypted[k]); //enc_dec=0
 				for (m=0; m < BLOCKSIZEB; m++)
 				{
 					putchar(hex[(Zynq_decrypted[k][m]>>4)&0xF]);
@@ -1697,15 +1608,19 @@ void random_vectors_test()
 
 
 /********************************************************************************************************
-  14. PRNG_application: this function prints on screen a 64-bit cryptographically secure pseudo-random number.
+  14. PRNG_application: this function prints on screen 64-bit cryptographically secure pseudo-random numbers.
+  The user chooses how many numbers to generate (up to PRNG_NUMBERS). They are generated at once by PRNG_fill, 
+  and only then printed.
   The seed data is also printed, to enable reproducing of the random stream.
   For cryptographic purposes, this data should be kept secret, and not used twice.
 *********************************************************************************************************/
 void PRNG_application()
 {
-	u8 result[BLOCKSIZEB], answer;
+	u8 result[PRNG_NUMBERS*BLOCKSIZEB], answer;
 	bool valid_answer, go = 1;
 	u16 i;
+	u32 k, numbers;
+	int c, fields;
 
 	xil_printf("*************************************************************** \n\r");
 	xil_printf("64-bit CSPRNG: Cryptographically Secure Pseudo-Random Number Generator \n");
@@ -1715,15 +1630,32 @@ void PRNG_application()
 	print_data("Key", PRNG_key, KEYSIZEB);
 	xil_printf("\n\r");
 	do {
-		PRNG(result);
-		for (i=0; i < BLOCKSIZEB; i++) // print as hexadecimal figures
+		do {
+			printf("How many random numbers do you want to generate? (1 - %u) \n\r", PRNG_NUMBERS);
+			numbers = 0;
+			fields = scanf("%u", &numbers);
+			if (fields == EOF)
+				return;
+			if (fields != 1) // not a number: discard the rest of the line, so it is not read again
+				do
+					c = getchar();
+				while ((c != '\n') && (c != '\r') && (c != EOF));
+			if ((numbers < 1) || (numbers > PRNG_NUMBERS))
+				xil_printf("Not a valid input. \n\r");
+		} while ((numbers < 1) || (numbers > PRNG_NUMBERS));
+		PRNG_fill(result, numbers*BLOCKSIZEB);
+		for (k=0; k < numbers; k++)
 		{
-			putchar(hex[(result[i]>>4)&0xF]);
-			putchar(hex[(result[i]   )&0xF]);
+			for (i=0; i < BLOCKSIZEB; i++) // print as hexadecimal figures
+			{
+				putchar(hex[(result[k*BLOCKSIZEB + i]>>4)&0xF]);
+				putchar(hex[(result[k*BLOCKSIZEB + i]   )&0xF]);
+			}
+			putchar('\n');
 		}
 		valid_answer = 0;
 		do {
-			printf("\n\nDo you want to generate another random number? Please answer y/n \n\r");
+			printf("\n\nDo you want to generate more random numbers? Please answer y/n \n\r");
 			scanf(" %c", &answer);
 			if ((answer == 'y') || (answer == 'Y') || (answer == '1'))
 				valid_answer = 1;
@@ -1951,6 +1883,8 @@ void performance_measurement()
 		bool new_IV = 1;
 
 		// first encryption anyway needs for keys preparation
+		// (with only_data = 0 every operation runs the key schedule, so the key reload elision is disabled):
+		khazad_hal_set_elision(&PL_hal, only_data);
 		Zynq_crypt(text1, key1,key2,key3,key4,IV1,IV2,0,enc_dec,op_mode,first_block,new_IV, result); // 0: generate keys
 		first_block = 0;
 		new_IV = 0;
@@ -2092,4 +2026,864 @@ void performance_measurement()
 	}
 }
 
-#endif
\ No newline at end of file
+
+/********************************************************************************************************
+  19. SW_benchmark: measures the execution time of the software implementations on the PS.
+  A buffer of BENCH_BLOCKS data blocks is encrypted and decrypted by each implementation, 
+  and the time is measured using the global timer (XTime).
+  The results of each implementation are compared to the reference code results, 
+  and the average time per data block is printed.
+  The MAC and CCM tags are compared to known answers, computed block by block with the reference code.
+*********************************************************************************************************/
+void SW_benchmark()
+{
+	// known answers of the benchmark message (key 00..0F, nonce 00010203):
+	static const u8 CBC_MAC_answer[BLOCKSIZEB] = {0x9A, 0x03, 0x39, 0x6C, 0x5F, 0x7B, 0x2B, 0x3A};
+	static const u8 PMAC_answer[BLOCKSIZEB]    = {0x43, 0x9D, 0x86, 0x4C, 0x3C, 0xC8, 0xA5, 0x6E};
+	static const u8 CCM_answer[CCM_TAGB]       = {0xEE, 0xC1, 0x76, 0xD7, 0x67, 0xA0, 0x36, 0x59};
+	struct NESSIEstruct subkeys;
+	u8 key[KEYSIZEB], CBC_Xor[BLOCKSIZEB], tag[CCM_TAGB], CCM_nonce[CCM_NONCEB] = {0, 1, 2, 3};
+	int status;
+	struct khazad_ctr ctr;
+	struct cbcmac_ctx mac_ctx;
+	XTime start, end;
+	u32 i;
+
+	xil_printf("*************************************************************** \n\r");
+	xil_printf("Software implementations benchmark, %u data blocks per measurement \n\r", BENCH_BLOCKS);
+
+	XGpioPs_WritePin(&my_Gpio, 47, 0);	// turn off the PS-ready indicator LED
+
+	for (i=0; i < KEYSIZEB; i++)
+		key[i] = (u8)i;
+	for (i=0; i < BENCH_BLOCKS*BLOCKSIZEB; i++)
+		bench_in[i] = (u8)(7*i + 1);
+	NESSIEkeysetup(key, &subkeys);  // calculate the round keys
+
+	// reference code, 32-bit state, 16 table lookups per round:
+	XTime_GetTime(&start);
+	for (i=0; i < BENCH_BLOCKS; i++)
+		NESSIEencrypt(&subkeys, bench_in + i*BLOCKSIZEB, bench_ref + i*BLOCKSIZEB);
+	XTime_GetTime(&end);
+	benchmark_report("reference encryption", start, end, BENCH_BLOCKS, 0, bench_ref, bench_ref);
+
+	// 64-bit state, 8 table lookups per round:
+	XTime_GetTime(&start);
+	for (i=0; i < BENCH_BLOCKS; i++)
+		NESSIEencrypt64(&subkeys, bench_in + i*BLOCKSIZEB, bench_out + i*BLOCKSIZEB);
+	XTime_GetTime(&end);
+	benchmark_report("64-bit encryption", start, end, BENCH_BLOCKS, 0, bench_out, bench_ref);
+
+	XTime_GetTime(&start);
+	for (i=0; i < BENCH_BLOCKS; i++)
+		NESSIEdecrypt64(&subkeys, bench_ref + i*BLOCKSIZEB, bench_out + i*BLOCKSIZEB);
+	XTime_GetTime(&end);
+	benchmark_report("64-bit decryption", start, end, BENCH_BLOCKS, 0, bench_out, bench_in);
+
+	// single 2 KB table, 8 table lookups and 7 byte swaps per round:
+	XTime_GetTime(&start);
+	for (i=0; i < BENCH_BLOCKS; i++)
+		NESSIEencrypt_compact(&subkeys, bench_in + i*BLOCKSIZEB, bench_out + i*BLOCKSIZEB);
+	XTime_GetTime(&end);
+	benchmark_report("single-table encryption", start, end, BENCH_BLOCKS, 0, bench_out, bench_ref);
+
+	XTime_GetTime(&start);
+	for (i=0; i < BENCH_BLOCKS; i++)
+		NESSIEdecrypt_compact(&subkeys, bench_ref + i*BLOCKSIZEB, bench_out + i*BLOCKSIZEB);
+	XTime_GetTime(&end);
+	benchmark_report("single-table decryption", start, end, BENCH_BLOCKS, 0, bench_out, bench_in);
+
+	// 64-bit state, T64_INTERLEAVE blocks interleaved in each round:
+	XTime_GetTime(&start);
+	NESSIEencrypt_blocks(&subkeys, bench_in, bench_out, BENCH_BLOCKS);
+	XTime_GetTime(&end);
+	benchmark_report("interleaved encryption", start, end, BENCH_BLOCKS, 0, bench_out, bench_ref);
+
+	XTime_GetTime(&start);
+	NESSIEdecrypt_blocks(&subkeys, bench_ref, bench_out, BENCH_BLOCKS);
+	XTime_GetTime(&end);
+	benchmark_report("interleaved decryption", start, end, BENCH_BLOCKS, 0, bench_out, bench_in);
+
+	// bitsliced, BS_LANES blocks in parallel, no table lookups:
+	XTime_GetTime(&start);
+	NESSIEencrypt_bitsliced(&subkeys, bench_in, bench_out, BENCH_BLOCKS);
+	XTime_GetTime(&end);
+	benchmark_report("bitsliced encryption", start, end, BENCH_BLOCKS, 0, bench_out, bench_ref);
+
+	XTime_GetTime(&start);
+	NESSIEdecrypt_bitsliced(&subkeys, bench_ref, bench_out, BENCH_BLOCKS);
+	XTime_GetTime(&end);
+	benchmark_report("bitsliced decryption", start, end, BENCH_BLOCKS, 0, bench_out, bench_in);
+
+	// SIMD (NEON), nibble shuffles for gamma, SIMD_BLOCKS blocks per vector:
+	XTime_GetTime(&start);
+	NESSIEencrypt_simd(&subkeys, bench_in, bench_out, BENCH_BLOCKS);
+	XTime_GetTime(&end);
+	benchmark_report("SIMD encryption", start, end, BENCH_BLOCKS, 0, bench_out, bench_ref);
+
+	XTime_GetTime(&start);
+	NESSIEdecrypt_simd(&subkeys, bench_ref, bench_out, BENCH_BLOCKS);
+	XTime_GetTime(&end);
+	benchmark_report("SIMD decryption", start, end, BENCH_BLOCKS, 0, bench_out, bench_in);
+
+	// CBC decryption: reference (block by block) vs. bulk and interleaved.
+	// bench_in is no longer needed as a reference, and the interleaved version runs in place on bench_ref,
+	// so these must be the last measurements:
+	for (i=0; i < BLOCKSIZEB; i++)
+		CBC_Xor[i] = (u8)i;
+	XTime_GetTime(&start);
+	for (i=0; i < BENCH_BLOCKS; i++)
+		NESSIEdecrypt_CBC(&subkeys, bench_ref + i*BLOCKSIZEB, CBC_Xor, bench_out + i*BLOCKSIZEB);
+	XTime_GetTime(&end);
+	benchmark_report("reference CBC decryption", start, end, BENCH_BLOCKS, 0, bench_out, bench_out);
+
+	for (i=0; i < BLOCKSIZEB; i++)
+		CBC_Xor[i] = (u8)i;
+	XTime_GetTime(&start);
+	NESSIEdecrypt_CBC_bulk(&subkeys, bench_ref, CBC_Xor, bench_in, BENCH_BLOCKS);
+	XTime_GetTime(&end);
+	benchmark_report("bulk CBC decryption", start, end, BENCH_BLOCKS, 0, bench_in, bench_out);
+
+	for (i=0; i < BLOCKSIZEB; i++)
+		CBC_Xor[i] = (u8)i;
+	XTime_GetTime(&start);
+	NESSIEdecrypt_CBC_blocks(&subkeys, bench_ref, CBC_Xor, bench_ref, BENCH_BLOCKS);
+	XTime_GetTime(&end);
+	benchmark_report("interleaved CBC decryption", start, end, BENCH_BLOCKS, 0, bench_ref, bench_out);
+
+	// key-agile: a new key for every data block (key i is 16 bytes of bench_in, from block i).
+	// bench_ref is free after the CBC measurements:
+	XTime_GetTime(&start);
+	for (i=0; i < BENCH_BLOCKS - 1; i++)
+	{
+		NESSIEkeysetup(bench_in + i*BLOCKSIZEB, &subkeys);
+		NESSIEencrypt(&subkeys, bench_in + i*BLOCKSIZEB, bench_out + i*BLOCKSIZEB);
+	}
+	XTime_GetTime(&end);
+	benchmark_report("reference key + block", start, end, BENCH_BLOCKS - 1, BENCH_BLOCKS - 1, bench_out, bench_out);
+
+	XTime_GetTime(&start);
+	for (i=0; i < BENCH_BLOCKS - 1; i++)
+	{
+		NESSIEkeysetup_encrypt(bench_in + i*BLOCKSIZEB, &subkeys);
+		NESSIEencrypt64(&subkeys, bench_in + i*BLOCKSIZEB, bench_ref + i*BLOCKSIZEB);
+	}
+	XTime_GetTime(&end);
+	benchmark_report("encrypt-only key + block", start, end, BENCH_BLOCKS - 1, BENCH_BLOCKS - 1, bench_ref, bench_out);
+
+	XTime_GetTime(&start);
+	for (i=0; i < BENCH_BLOCKS - 1; i++)
+		NESSIEencrypt_keyagile(bench_in + i*BLOCKSIZEB, bench_in + i*BLOCKSIZEB, bench_ref + i*BLOCKSIZEB);
+	XTime_GetTime(&end);
+	benchmark_report("key-agile key + block", start, end, BENCH_BLOCKS - 1, BENCH_BLOCKS - 1, bench_ref, bench_out);
+
+	// CTR mode: whole-buffer function vs. the CTR engine, called with a partial first block
+	// (the key stream position is kept between the calls):
+	NESSIEkeysetup(key, &subkeys);
+	for (i=0; i < BLOCKSIZEB; i++)
+		CBC_Xor[i] = (u8)i;  // initial counter block
+	XTime_GetTime(&start);
+	NESSIEcrypt_CTR_bulk(&subkeys, CBC_Xor, bench_in, bench_out, BENCH_BLOCKS);
+	XTime_GetTime(&end);
+	benchmark_report("bulk CTR", start, end, BENCH_BLOCKS, 0, bench_out, bench_out);
+
+	for (i=0; i < BLOCKSIZEB; i++)
+		CBC_Xor[i] = (u8)i;
+	XTime_GetTime(&start);
+	khazad_ctr_init(&ctr, &subkeys, CBC_Xor);
+	khazad_ctr_crypt(&ctr, bench_in, bench_ref, 3);
+	khazad_ctr_crypt(&ctr, bench_in + 3, bench_ref + 3, BENCH_BLOCKS*BLOCKSIZEB - 3);
+	XTime_GetTime(&end);
+	benchmark_report("CTR engine", start, end, BENCH_BLOCKS, 0, bench_ref, bench_out);
+
+	// constant-time CTR: the bitsliced key stream (BS_LANES counter blocks per pass), the same as above:
+	for (i=0; i < BLOCKSIZEB; i++)
+		CBC_Xor[i] = (u8)i;
+	XTime_GetTime(&start);
+	NESSIEcrypt_CTR_bitsliced(&subkeys, CBC_Xor, bench_in, bench_ref, BENCH_BLOCKS);
+	XTime_GetTime(&end);
+	benchmark_report("bitsliced CTR", start, end, BENCH_BLOCKS, 0, bench_ref, bench_out);
+
+	for (i=0; i < BLOCKSIZEB; i++)
+		CBC_Xor[i] = (u8)i;
+	XTime_GetTime(&start);
+	khazad_ctr_init(&ctr, &subkeys, CBC_Xor);
+	khazad_ctr_set_bitsliced(&ctr, 1);
+	khazad_ctr_crypt(&ctr, bench_in, bench_ref, 3);
+	khazad_ctr_crypt(&ctr, bench_in + 3, bench_ref + 3, BENCH_BLOCKS*BLOCKSIZEB - 3);
+	XTime_GetTime(&end);
+	benchmark_report("constant-time CTR engine", start, end, BENCH_BLOCKS, 0, bench_ref, bench_out);
+
+	// authenticated encryption: CTR and CBC-MAC in two passes vs. the single-pass CCM engine.
+	// The CCM ciphertext is the CTR ciphertext from the counter block CCM_nonce || 00000001:
+	for (i=0; i < BLOCKSIZEB; i++)
+		CBC_Xor[i] = (i < CCM_NONCEB) ? CCM_nonce[i] : 0;
+	CBC_Xor[BLOCKSIZEB-1] = 1;
+	XTime_GetTime(&start);
+	NESSIEcrypt_CTR_bulk(&subkeys, CBC_Xor, bench_in, bench_out, BENCH_BLOCKS);
+	cbcmac_init(&mac_ctx, key, 0);
+	cbcmac_update(&mac_ctx, bench_in, BENCH_BLOCKS*BLOCKSIZEB);
+	cbcmac_final(&mac_ctx, tag);
+	XTime_GetTime(&end);
+	benchmark_report("two-pass CTR + CBC-MAC", start, end, BENCH_BLOCKS, 0, bench_out, bench_out);
+
+	XTime_GetTime(&start);
+	khazad_ccm_encrypt(&subkeys, CCM_nonce, bench_in, bench_ref, BENCH_BLOCKS*BLOCKSIZEB, tag);
+	XTime_GetTime(&end);
+	benchmark_report("single-pass CCM", start, end, BENCH_BLOCKS, 0, bench_ref, bench_out);
+	if (memcmp(tag, CCM_answer, CCM_TAGB) != 0)
+		printf("%25s  ** the tag differs from the known answer! ** \n\r", "");
+
+	XTime_GetTime(&start);
+	status = khazad_ccm_decrypt(&subkeys, CCM_nonce, bench_ref, bench_out, BENCH_BLOCKS*BLOCKSIZEB, tag);
+	XTime_GetTime(&end);
+	benchmark_report("CCM decryption", start, end, BENCH_BLOCKS, 0, bench_out, bench_in);
+	tag[0] ^= 1;  // a forged tag must be rejected, and the plaintext erased
+	if (status != 0 || khazad_ccm_decrypt(&subkeys, CCM_nonce, bench_ref, bench_out, BENCH_BLOCKS*BLOCKSIZEB, tag) != -1
+		|| bench_out[0] != 0)
+		printf("%25s  ** the tag verification failed! ** \n\r", "");
+
+	// MAC: CBC-MAC (every block encryption waits for the previous one) vs. PMAC (independent block
+	// encryptions, interleaved by NESSIEencrypt_blocks):
+	XTime_GetTime(&start);
+	cbcmac_init(&mac_ctx, key, 0);
+	cbcmac_update(&mac_ctx, bench_in, BENCH_BLOCKS*BLOCKSIZEB);
+	cbcmac_final(&mac_ctx, tag);
+	XTime_GetTime(&end);
+	benchmark_report("CBC-MAC", start, end, BENCH_BLOCKS, 0, tag, NULL);
+	if (memcmp(tag, CBC_MAC_answer, BLOCKSIZEB) != 0)
+		printf("%25s  ** the tag differs from the known answer! ** \n\r", "");
+
+	XTime_GetTime(&start);
+	khazad_pmac(&subkeys, bench_in, BENCH_BLOCKS*BLOCKSIZEB, tag);
+	XTime_GetTime(&end);
+	benchmark_report("PMAC", start, end, BENCH_BLOCKS, 0, tag, NULL);
+	if (memcmp(tag, PMAC_answer, BLOCKSIZEB) != 0)
+		printf("%25s  ** the tag differs from the known answer! ** \n\r", "");
+
+	XGpioPs_WritePin(&my_Gpio, 47, 1);	// turn on the PS-ready indicator LED
+}
+
+
+/********************************************************************************************************
+  20. benchmark_report: prints the average time per data block of one benchmark measurement, 
+  and compares the measured implementation results to the expected results.
+  For key-agile measurements (keys > 0), the number of keys per second is printed too.
+  With reference = NULL nothing is compared (a MAC tag, which the caller compares to its known answer).
+*********************************************************************************************************/
+void benchmark_report(char *name, XTime start, XTime end, u32 blocks, u32 keys, u8 *result, u8 *reference)
+{
+	u64 ns = ((u64)(end - start) * 1000000000ULL) / COUNTS_PER_SECOND; // global timer ticks to nanoseconds
+
+	printf("%25s: %6llu ns per block, %8llu blocks per second", name, ns / blocks, ((u64)blocks * 1000000000ULL) / (ns ? ns : 1));
+	if (keys)
+		printf(", %8llu keys per second", ((u64)keys * 1000000000ULL) / (ns ? ns : 1));
+	if (reference && memcmp(result, reference, blocks*BLOCKSIZEB) != 0)
+		printf("  ** results differ from the reference code! **");
+	printf("\n\r");
+}
+
+
+/********************************************************************************************************
+  21. PRNG_fill: fills a buffer of any length with pseudo-random bytes, from the same stream as PRNG 
+  (the input blocks are (nonce << 32) + counter, encrypted in HW with PRNG_key).
+  The key is sent to the PL only for the first block. The next blocks use the only_data option, 
+  so the PL skips the key schedule (8 clock cycles per block instead of 24), and the four key registers 
+  are not written again.
+  The HW key is changed, so the next HW operation of another application must send its key (only_data = 0).
+  buf: pointer to the u8 output array.
+  len: number of random bytes. The last data block may be used partially.
+*********************************************************************************************************/
+void PRNG_fill(u8 * const buf, const u32 len)
+{
+	u8 input[BLOCKSIZEB], result[BLOCKSIZEB];
+	u64 block, base;
+	u32 key1, key2, key3, key4, i, n;
+
+	// map u8-array PRNG_key to four u32 key parts:
+	key1 = ((u32)PRNG_key[ 0] << 24) ^ ((u32)PRNG_key[ 1] << 16) ^ ((u32)PRNG_key[ 2] << 8) ^ ((u32)PRNG_key[ 3]);
+	key2 = ((u32)PRNG_key[ 4] << 24) ^ ((u32)PRNG_key[ 5] << 16) ^ ((u32)PRNG_key[ 6] << 8) ^ ((u32)PRNG_key[ 7]);
+	key3 = ((u32)PRNG_key[ 8] << 24) ^ ((u32)PRNG_key[ 9] << 16) ^ ((u32)PRNG_key[10] << 8) ^ ((u32)PRNG_key[11]);
+	key4 = ((u32)PRNG_key[12] << 24) ^ ((u32)PRNG_key[13] << 16) ^ ((u32)PRNG_key[14] << 8) ^ ((u32)PRNG_key[15]);
+	base = ((u64)nonce[0] << 56) ^ ((u64)nonce[1] << 48) ^ ((u64)nonce[2] << 40) ^ ((u64)nonce[3] << 32);
+
+	for (i=0; i < len; i += n)
+	{
+		block = base + counter;
+		for (n=0; n < BLOCKSIZEB; n++)
+			input[n] = (u8)(block >> (56 - 8*n));
+		// ECB encryption, the key is sent only with the first block:
+		Zynq_crypt(input, key1, key2, key3, key4, 0, 0, i != 0, 1, 0, 0, 0, result);
+		counter++;
+		n = (len - i < BLOCKSIZEB) ? len - i : BLOCKSIZEB;
+		memcpy(buf + i, result, n);
+	}
+}
+
+
+/********************************************************************************************************
+  22. cbcmac_blocks: adds whole data blocks to a CBC-MAC, directly from the caller's buffer.
+  HW: the PL design runs in CBC mode, by Zynq_crypt_blocks in chunks of BULK_CHUNK_BLOCKS through a local buffer. 
+  The key and the chaining value (as the IV) are sent with the first block of every chunk, so other HW operations 
+  may run between the calls; the next blocks are sent with only_data.
+  SW: CBC encryption with the 64-bit software engine, where only the last ciphertext block is kept.
+  ctx: the CBC-MAC state, after cbcmac_init.
+  data: pointer to the u8 input array.
+  blocks: number of data blocks.
+*********************************************************************************************************/
+static void cbcmac_blocks(struct cbcmac_ctx * const ctx, const u8 *data, u32 blocks)
+{
+	u8 buffer[BULK_CHUNK_BLOCKS*BLOCKSIZEB];
+	u32 i, j, n;
+
+	if (blocks == 0)
+		return;
+
+	if (ctx->HW)
+	{
+		for (i=0; i < blocks; i += n, data += n*BLOCKSIZEB) // op_mode=1, enc_dec=1
+		{
+			n = (blocks - i < BULK_CHUNK_BLOCKS) ? blocks - i : BULK_CHUNK_BLOCKS;
+			Zynq_crypt_blocks(&ctx->session, data, buffer, n, 1, 1);	// continues the chain of ctx->session.IV
+		}
+		memcpy(ctx->chain, buffer + (n-1)*BLOCKSIZEB, BLOCKSIZEB);
+	}
+	else
+	{
+		for (i=0; i < blocks; i++, data += BLOCKSIZEB)
+		{
+			for (j=0; j < BLOCKSIZEB; j++)
+				ctx->chain[j] ^= data[j];
+			NESSIEencrypt64(&ctx->subkeys, ctx->chain, ctx->chain);
+		}
+	}
+	ctx->blocks += blocks;
+}
+
+
+/********************************************************************************************************
+  23. cbcmac_init: starts a new CBC-MAC (zero IV), in HW or in SW.
+  ctx: the CBC-MAC state.
+  key: pointer to the u8 key array (KEYSIZEB bytes).
+  HW: 1 for the PL design, 0 for the software engine.
+*********************************************************************************************************/
+void cbcmac_init(struct cbcmac_ctx * const ctx, const u8 * const key, const bool HW)
+{
+	ctx->HW = HW;
+	if (HW)
+		khazad_hal_ctx_init(&ctx->session, key, NULL);	// zero IV
+	else
+		NESSIEkeysetup(key, &ctx->subkeys);
+	memset(ctx->chain, 0, BLOCKSIZEB);
+	ctx->partial_len = 0;
+	ctx->blocks = 0;
+}
+
+
+/********************************************************************************************************
+  24. cbcmac_update: adds a chunk of any length to a CBC-MAC. The whole data blocks are processed directly 
+  from the caller's buffer, and an incomplete last block is kept in the state for the next call.
+  ctx: the CBC-MAC state.
+  data: pointer to the u8 input array.
+  len: number of bytes.
+*********************************************************************************************************/
+void cbcmac_update(struct cbcmac_ctx * const ctx, const u8 *data, u32 len)
+{
+	u32 n;
+
+	// complete the kept block first:
+	if (ctx->partial_len)
+	{
+		n = BLOCKSIZEB - ctx->partial_len;
+		if (n > len)
+			n = len;
+		memcpy(ctx->partial + ctx->partial_len, data, n);
+		ctx->partial_len += n;
+		data += n;
+		len -= n;
+		if (ctx->partial_len < BLOCKSIZEB)
+			return;
+		cbcmac_blocks(ctx, ctx->partial, 1);
+		ctx->partial_len = 0;
+	}
+
+	// whole blocks, without copying:
+	cbcmac_blocks(ctx, data, len / BLOCKSIZEB);
+
+	// keep the residue:
+	ctx->partial_len = len % BLOCKSIZEB;
+	memcpy(ctx->partial, data + len - ctx->partial_len, ctx->partial_len);
+}
+
+
+/********************************************************************************************************
+  25. cbcmac_final: completes a CBC-MAC. A residue is zero padded (as in CBC_MAC), 
+  and an empty message is one zero block. The state should be initialized again before it is re-used.
+  ctx: the CBC-MAC state.
+  mac: pointer to the u8 output array (BLOCKSIZEB bytes).
+*********************************************************************************************************/
+void cbcmac_final(struct cbcmac_ctx * const ctx, u8 * const mac)
+{
+	if (ctx->partial_len || ctx->blocks == 0)
+	{
+		memset(ctx->partial + ctx->partial_len, 0, BLOCKSIZEB - ctx->partial_len);	// zero padding
+		cbcmac_blocks(ctx, ctx->partial, 1);
+		ctx->partial_len = 0;
+	}
+	memcpy(mac, ctx->chain, BLOCKSIZEB);
+}
+
+
+/********************************************************************************************************
+  26. Zynq_ccm: single-pass authenticated encryption/decryption in HW (CTR encryption and CBC-MAC), 
+  with the same format and results as the software engine ("khazad-ccm.h"), by khazad_hal_ccm (khazad-hal-auth.h).
+  Each message block is read once: the PL design runs in ECB mode, and for every block encrypts the 
+  CBC-MAC state and the next counter block, while the PS does the CBC chaining XOR and the key stream XOR.
+  The key is sent only with the first block, and all the other blocks use the only_data option.
+  The HW key is changed, so the next HW operation of another application must send its key (only_data = 0).
+  text: pointer to the u8 input array (plaintext or ciphertext).
+  key: pointer to the u8 key array (KEYSIZEB bytes).
+  CCM_nonce: pointer to the u8 nonce array (CCM_NONCEB bytes), unique for every message of the key.
+  len: number of bytes, up to CCM_MAX_LENGTH (the 31-bit length field of B0).
+  enc_dec: 1 for encryption, 0 for decryption.
+  result: pointer to the u8 output array, of len bytes (may be the same array as text).
+  tag: encryption - the computed tag, decryption - the received tag (CCM_TAGB bytes).
+  Returns 0, or -1 if a decrypted message is not authentic (the result is then erased), 
+  or if len is above CCM_MAX_LENGTH (nothing is processed).
+*********************************************************************************************************/
+int Zynq_ccm(const u8 * const text, const u8 * const key, const u8 * const CCM_nonce, const u32 len, const bool enc_dec, u8 * const result, u8 * const tag)
+{
+	khazad_wait(PL_queue.submitted); // the PL runs one operation at a time
+	return khazad_hal_ccm(&PL_hal, key, CCM_nonce, text, len, enc_dec, result, tag);
+}
+
+
+/********************************************************************************************************
+  27. Zynq_pmac: computes the PMAC of a message in HW, with the same results as the software engine 
+  ("khazad-pmac.h"), by khazad_hal_pmac (khazad-hal-auth.h). 
+  The PL design runs in ECB mode, and the blocks are sent back to back: the input of every block depends only on the message and the offset (computed by the PS), 
+  not on the previous result, as in CBC-MAC. The key is sent only with the first block (L = E(0)).
+  The HW key is changed, so the next HW operation of another application must send its key (only_data = 0).
+  text: pointer to the u8 message array.
+  key: pointer to the u8 key array (KEYSIZEB bytes).
+  len: number of bytes (any length, including 0).
+  tag: pointer to the u8 output array (BLOCKSIZEB bytes).
+*********************************************************************************************************/
+void Zynq_pmac(const u8 * const text, const u8 * const key, const u32 len, u8 * const tag)
+{
+	khazad_wait(PL_queue.submitted); // the PL runs one operation at a time
+	khazad_hal_pmac(&PL_hal, key, text, len, tag);
+}
+
+
+#ifdef HAL_DONE_IRQ
+/********************************************************************************************************
+  28. PL_done_ISR: the PL done Interrupt Service Routine (done_IRQ of controller.v, IRQ_F2P[0]).
+  The interrupt only wakes up the core from WFI in the spin-then-sleep completion wait of Zynq_crypt 
+  (khazad-hal.h). The GIC acknowledges the edge interrupt, and the ready flag is read again after WFI.
+  The interrupt is enabled by PL_hal only while sleeping. Compiled with HAL_DONE_IRQ only.
+*********************************************************************************************************/
+static void PL_done_ISR(void *CallBackReff)
+{
+	PL_interrupts++;
+}
+#endif
+
+
+/********************************************************************************************************
+  29. completion_report: compares the completion wait modes of Zynq_crypt, on BENCH_BLOCKS ECB encryptions 
+  (the key with the first block, then only_data blocks, as HW_application):
+  polling (HAL_WAIT_POLL), spin-then-sleep (HAL_WAIT_HYBRID, HAL_SPIN_POLLS polls before WFI), and sleep 
+  after one poll (HAL_WAIT_HYBRID, 0 spin polls).
+  For each mode, the latency (average time per data block), the ready flag polls and WFI sleeps per block, 
+  the interrupts and the sleeps ended by the timer, and the CPU utilization (the part of the time the core 
+  was not asleep) are printed.
+  The sleep modes need done_IRQ, so without HAL_DONE_IRQ (the version 2.0 PL design) only polling is measured.
+  The key operation (26 PL clock cycles) is long enough to sleep, while only_data operations 
+  (10 PL clock cycles) usually end during the spin.
+  The Zynq_crypt_blocks line is the same encryption by one multi-block call (polling), where the next block 
+  is sent while the PL runs.
+  Then the same blocks are encrypted with PS work for each block (the reference encryption and comparison), 
+  once with Zynq_crypt (the PS waits for the PL, then works), and once with the job queue (the PS works 
+  on the previous block while the PL encrypts the next one).
+*********************************************************************************************************/
+void completion_report()
+{
+	static const char *name[3] = {"polling", "spin-then-sleep", "sleep"};
+	static const u8 wait_mode[3] = {HAL_WAIT_POLL, HAL_WAIT_HYBRID, HAL_WAIT_HYBRID};
+	static const u32 spin_polls[3] = {0, HAL_SPIN_POLLS, 0};
+	struct NESSIEstruct subkeys;
+	u8 key[KEYSIZEB];
+	u32 key1, key2, key3, key4, i, m, errors, ticket;
+#ifdef HAL_DONE_IRQ
+	u32 interrupts, timeouts;
+#endif
+	struct khazad_job job;
+	struct khazad_hal_ctx ctx;
+	u8 reference[BLOCKSIZEB];
+	XTime start, end;
+
+	xil_printf("*************************************************************** \n\r");
+	xil_printf("Hardware completion wait modes, %u data blocks per measurement \n\r", BENCH_BLOCKS);
+
+	XGpioPs_WritePin(&my_Gpio, 47, 0);	// turn off the PS-ready indicator LED
+
+	for (i=0; i < KEYSIZEB; i++)
+		key[i] = (u8)i;
+	for (i=0; i < BENCH_BLOCKS*BLOCKSIZEB; i++)
+		bench_in[i] = (u8)(7*i + 1);
+	NESSIEkeysetup(key, &subkeys);
+	for (i=0; i < BENCH_BLOCKS; i++)
+		NESSIEencrypt64(&subkeys, bench_in + i*BLOCKSIZEB, bench_ref + i*BLOCKSIZEB);
+	key1 = ((u32)key[ 0] << 24) ^ ((u32)key[ 1] << 16) ^ ((u32)key[ 2] << 8) ^ ((u32)key[ 3]);
+	key2 = ((u32)key[ 4] << 24) ^ ((u32)key[ 5] << 16) ^ ((u32)key[ 6] << 8) ^ ((u32)key[ 7]);
+	key3 = ((u32)key[ 8] << 24) ^ ((u32)key[ 9] << 16) ^ ((u32)key[10] << 8) ^ ((u32)key[11]);
+	key4 = ((u32)key[12] << 24) ^ ((u32)key[13] << 16) ^ ((u32)key[14] << 8) ^ ((u32)key[15]);
+
+	for (m=0; m < COMPLETION_MODES; m++)
+	{
+		khazad_hal_set_wait(&PL_hal, wait_mode[m], spin_polls[m]);
+		khazad_hal_clear_stats(&PL_hal);
+#ifdef HAL_DONE_IRQ
+		interrupts = PL_interrupts;
+		timeouts = PL_timeouts;
+#endif
+		XTime_GetTime(&start);
+		for (i=0; i < BENCH_BLOCKS; i++)
+			Zynq_crypt(bench_in + i*BLOCKSIZEB, key1, key2, key3, key4, 0, 0, i != 0, 1, 0, 0, 0, bench_out + i*BLOCKSIZEB);
+		XTime_GetTime(&end);
+		benchmark_report((char *)name[m], start, end, BENCH_BLOCKS, 0, bench_out, bench_ref);
+#ifdef HAL_DONE_IRQ
+		printf("%25s  %u.%02u polls, %u.%02u sleeps per block, %u interrupts, %u timeouts, CPU utilization %llu%% \n\r", "",
+			   PL_hal.stats.polls / BENCH_BLOCKS, (100*PL_hal.stats.polls / BENCH_BLOCKS) % 100,
+			   PL_hal.stats.sleeps / BENCH_BLOCKS, (100*PL_hal.stats.sleeps / BENCH_BLOCKS) % 100,
+			   PL_interrupts - interrupts, PL_timeouts - timeouts,
+			   100 - (100*PL_hal.stats.sleep_time) / ((end - start) ? (end - start) : 1));
+#else
+		printf("%25s  %u.%02u polls per block \n\r", "",
+			   PL_hal.stats.polls / BENCH_BLOCKS, (100*PL_hal.stats.polls / BENCH_BLOCKS) % 100);
+#endif
+	}
+#ifndef HAL_DONE_IRQ
+	xil_printf("(the sleep modes need HAL_DONE_IRQ, and a PL design with done_IRQ on IRQ_F2P[0]) \n\r");
+#endif
+	khazad_hal_set_wait(&PL_hal, HAL_WAIT_POLL, HAL_SPIN_POLLS);
+
+	// multi-block call:
+	khazad_hal_ctx_init(&ctx, key, NULL);
+	khazad_hal_clear_stats(&PL_hal);
+	XTime_GetTime(&start);
+	Zynq_crypt_blocks(&ctx, bench_in, bench_out, BENCH_BLOCKS, 0, 1);
+	XTime_GetTime(&end);
+	benchmark_report("Zynq_crypt_blocks", start, end, BENCH_BLOCKS, 0, bench_out, bench_ref);
+	printf("%25s  %u.%02u polls per block \n\r", "",
+		   PL_hal.stats.polls / BENCH_BLOCKS, (100*PL_hal.stats.polls / BENCH_BLOCKS) % 100);
+
+	// synchronous: PL operation, then PS work:
+	errors = 0;
+	XTime_GetTime(&start);
+	for (i=0; i < BENCH_BLOCKS; i++)
+	{
+		Zynq_crypt(bench_in + i*BLOCKSIZEB, key1, key2, key3, key4, 0, 0, i != 0, 1, 0, 0, 0, bench_out + i*BLOCKSIZEB);
+		NESSIEencrypt64(&subkeys, bench_in + i*BLOCKSIZEB, reference);
+		errors += (memcmp(reference, bench_out + i*BLOCKSIZEB, BLOCKSIZEB) != 0);
+	}
+	XTime_GetTime(&end);
+	benchmark_report("Zynq_crypt + PS work", start, end, BENCH_BLOCKS, 0, bench_out, bench_ref);
+
+	// asynchronous: the PS works on block i-1 while the PL encrypts block i:
+	job.key1 = key1; job.key2 = key2; job.key3 = key3; job.key4 = key4;
+	job.IV1 = 0; job.IV2 = 0;
+	job.enc_dec = 1; job.op_mode = 0; job.first_block = 0; job.new_IV = 0;
+	ticket = PL_queue.submitted; // the ticket of block i is ticket + i + 1
+	XTime_GetTime(&start);
+	for (i=0; i <= BENCH_BLOCKS; i++)
+	{
+		if (i < BENCH_BLOCKS)
+		{
+			job.text = bench_in + i*BLOCKSIZEB;
+			job.result = bench_out + i*BLOCKSIZEB;
+			job.only_data = (i != 0);
+			khazad_submit(&job);
+		}
+		if (i > 0)
+		{
+			NESSIEencrypt64(&subkeys, bench_in + (i-1)*BLOCKSIZEB, reference);
+			khazad_wait(ticket + i); // block i-1
+			errors += (memcmp(reference, bench_out + (i-1)*BLOCKSIZEB, BLOCKSIZEB) != 0);
+		}
+	}
+	XTime_GetTime(&end);
+	benchmark_report("job queue + PS work", start, end, BENCH_BLOCKS, 0, bench_out, bench_ref);
+	if (errors)
+		printf("%25s  %u blocks differ from the reference encryption \n\r", "", errors);
+
+	XGpioPs_WritePin(&my_Gpio, 47, 1);	// turn on the PS-ready indicator LED
+}
+
+
+/********************************************************************************************************
+  30. khazad_submit: submits an asynchronous "crypt" job to the PL design (job queue, khazad-queue.h).
+  The job starts at once if the PL is idle, or after the jobs submitted before it; the function returns 
+  without waiting for the result (unless the queue is full).
+  job: pointer to the job parameters: the input and output data blocks, and the Zynq_crypt parameters.
+  The data blocks must stay valid until the job completes.
+  Function returns: the job ticket, for khazad_wait.
+*********************************************************************************************************/
+u32 khazad_submit(const struct khazad_job * const job)
+{
+	return khazad_queue_submit(&PL_queue, job);
+}
+
+
+/********************************************************************************************************
+  31. khazad_poll: advances the job queue without waiting: if the running job has ended, its result is read 
+  and the next job is started. Call it during long PS work, to keep the PL busy.
+  Function returns: the number of completed jobs (the ticket of the last completed job).
+*********************************************************************************************************/
+u32 khazad_poll()
+{
+	return khazad_queue_poll(&PL_queue);
+}
+
+
+/********************************************************************************************************
+  32. khazad_wait: waits until a job, and all the jobs submitted before it, have completed.
+  ticket: the job ticket (from khazad_submit), or PL_queue.submitted for all the jobs.
+*********************************************************************************************************/
+void khazad_wait(const u32 ticket)
+{
+	khazad_queue_wait(&PL_queue, ticket);
+}
+
+
+
+/********************************************************************************************************
+  33. Zynq_crypt_blocks: encrypts or decrypts a buffer of whole data blocks in the PL design (the bulk path).
+  The key (and the IV in CBC mode) is sent with the first block only, and all the other blocks are sent with 
+  only_data; the data words are packed and unpacked as whole words, and while the PL runs an only_data block, 
+  the next one is already sent (khazad_hal_crypt_blocks, khazad-hal.h). Jobs submitted by khazad_submit are completed first.
+  ctx: pointer to the session context: the key and the IV (khazad_hal_ctx_init). In CBC mode ctx->IV is updated to 
+  the last ciphertext block, so a long message may be processed by several calls.
+  in: pointer to the u8 input array.
+  out: pointer to the u8 output array (may be in).
+  nblocks: number of data blocks.
+  op_mode: flag to the desired cryptographic mode of operation. 1: CBC. 0: ECB.
+  enc_dec: flag to the desired operation.						1: encryption. 0: decryption.
+*********************************************************************************************************/
+void Zynq_crypt_blocks(struct khazad_hal_ctx * const ctx, const u8 * const in, u8 * const out, const u32 nblocks, const bool op_mode, const bool enc_dec)
+{
+	khazad_wait(PL_queue.submitted); // the PL runs one operation at a time
+	khazad_hal_crypt_blocks(&PL_hal, ctx, in, out, nblocks, op_mode, enc_dec);
+}
+
+
+
+/********************************************************************************************************
+  34. Zynq_crypt_hybrid: processes a buffer of data blocks by the PL design and the software engine together 
+  (hybrid HW+SW dispatcher, khazad-hybrid.h), for ECB encryption/decryption, CTR and CBC decryption.
+  The PL takes blocks from the front of the buffer, and while each PL block runs, the PS encrypts blocks 
+  from the back with the software engine, as many as the PL wait pays for, until the two ends meet.
+  The split follows the times measured by khazad_hybrid_calibrate on the first call (PL bus accesses, PL wait, 
+  software block); if the software engine alone is faster, it processes the whole buffer.
+  Jobs submitted by khazad_submit are completed first.
+  subkeys: pointer to the expanded key (NESSIEkeysetup), for the software engine.
+  ctx: pointer to the same key, for the PL (khazad_hal_ctx_init).
+  mode: KHAZAD_HYBRID_ENCRYPT, KHAZAD_HYBRID_DECRYPT, KHAZAD_HYBRID_CTR or KHAZAD_HYBRID_CBC_DECRYPT.
+  in: pointer to the u8 input array.
+  out: pointer to the u8 output array (the same as in, or not overlapping it).
+  IV: CTR: the counter block, CBC decryption: the IV; updated for the next call. ECB: NULL.
+  nblocks: number of data blocks.
+*********************************************************************************************************/
+void Zynq_crypt_hybrid(const struct NESSIEstruct * const subkeys, const struct khazad_hal_ctx * const ctx, const int mode, const u8 * const in, u8 * const out, u8 * const IV, const u32 nblocks)
+{
+	khazad_wait(PL_queue.submitted); // the PL runs one operation at a time
+	if (PL_hybrid.sw_block == 0)
+		khazad_hybrid_calibrate(&PL_hybrid, subkeys, ctx);
+	khazad_hybrid_crypt(&PL_hybrid, subkeys, ctx, mode, in, out, IV, nblocks);
+}
+
+
+/********************************************************************************************************
+  35. hybrid_report: compares the PL alone, the software engine alone and the hybrid dispatcher 
+  (Zynq_crypt_hybrid), on BENCH_BLOCKS data blocks of ECB encryption, CTR and CBC decryption.
+  The measured times of the dispatcher (in global timer ticks) and the split of the hybrid run are printed.
+*********************************************************************************************************/
+void hybrid_report()
+{
+	static const char *name[3] = {"ECB encryption", "CTR", "CBC decryption"};
+	static const int mode[3] = {KHAZAD_HYBRID_ENCRYPT, KHAZAD_HYBRID_CTR, KHAZAD_HYBRID_CBC_DECRYPT};
+	static const char *engine[3] = {"PL alone", "software alone", "PL + software"};
+	struct NESSIEstruct subkeys;
+	struct khazad_hal_ctx ctx;
+	struct khazad_hybrid measured;
+	u8 key[KEYSIZEB], IV[BLOCKSIZEB], chain[BLOCKSIZEB];
+	char label[32];
+	u32 i, m, e;
+	XTime start, end;
+
+	xil_printf("*************************************************************** \n\r");
+	xil_printf("Hybrid HW+SW dispatcher, %u data blocks per measurement \n\r", BENCH_BLOCKS);
+
+	XGpioPs_WritePin(&my_Gpio, 47, 0);	// turn off the PS-ready indicator LED
+
+	for (i=0; i < KEYSIZEB; i++)
+		key[i] = (u8)i;
+	for (i=0; i < BLOCKSIZEB; i++)
+		IV[i] = (u8)(0xF0 - i);
+	for (i=0; i < BENCH_BLOCKS*BLOCKSIZEB; i++)
+		bench_in[i] = (u8)(7*i + 1);
+	NESSIEkeysetup(key, &subkeys);
+	khazad_hal_ctx_init(&ctx, key, NULL);
+	khazad_wait(PL_queue.submitted);
+	khazad_hybrid_calibrate(&PL_hybrid, &subkeys, &ctx);
+	measured = PL_hybrid;
+	printf("Measured times per block: PL bus accesses %u, PL wait %u, software block %u (global timer ticks) \n\r",
+		   measured.hw_bus, measured.hw_wait, measured.sw_block);
+
+	for (m=0; m < 3; m++)
+	{
+		// the software reference:
+		memcpy(chain, IV, BLOCKSIZEB);
+		if (mode[m] == KHAZAD_HYBRID_ENCRYPT)
+			NESSIEencrypt_blocks(&subkeys, bench_in, bench_ref, BENCH_BLOCKS);
+		else if (mode[m] == KHAZAD_HYBRID_CTR)
+			NESSIEcrypt_CTR_bulk(&subkeys, chain, bench_in, bench_ref, BENCH_BLOCKS);
+		else
+			NESSIEdecrypt_CBC_bulk(&subkeys, bench_in, chain, bench_ref, BENCH_BLOCKS);
+
+		for (e=0; e < 3; e++)
+		{
+			PL_hybrid.hw_bus = measured.hw_bus;
+			PL_hybrid.hw_wait = measured.hw_wait;
+			PL_hybrid.sw_block = measured.sw_block;
+			if (e == 0)
+				PL_hybrid.sw_block = 0;  // no software blocks
+			else if (e == 1)
+				PL_hybrid.hw_bus = PL_hybrid.sw_block;  // the software engine alone
+			memcpy(chain, IV, BLOCKSIZEB);
+			XTime_GetTime(&start);
+			khazad_hybrid_crypt(&PL_hybrid, &subkeys, &ctx, mode[m], bench_in, bench_out, chain, BENCH_BLOCKS);
+			XTime_GetTime(&end);
+			snprintf(label, sizeof(label), "%s, %s", name[m], engine[e]);
+			benchmark_report(label, start, end, BENCH_BLOCKS, 0, bench_out, bench_ref);
+			if (e == 2)
+				printf("%25s  %u PL blocks, %u software blocks \n\r", "", PL_hybrid.hw_blocks, PL_hybrid.sw_blocks);
+		}
+	}
+	PL_hybrid = measured;
+
+	XGpioPs_WritePin(&my_Gpio, 47, 1);	// turn on the PS-ready indicator LED
+}
+
+
+/********************************************************************************************************
+  36. timer_now: the global timer, the time source of the hybrid dispatcher and the HW/SW selection calibrations.
+*********************************************************************************************************/
+static u64 timer_now()
+{
+	XTime now;
+
+	XTime_GetTime(&now);
+	return now;
+}
+
+
+
+/********************************************************************************************************
+  37. autoselect_calibration: measures the PL design and the software engine for each mode (ECB and CBC, 
+  encryption and decryption) and each message size class (1, 2, 4, ..., BENCH_BLOCKS data blocks), and fills 
+  the selection table of Zynq_crypt_auto (khazad_autoselect_calibrate, khazad-autoselect.h).
+  Neither path is charged a key setup: the PL is timed with the key resident (key reload elision), as the requests 
+  of a session find it, and the software engine with the expanded key ready.
+  Called once at startup, after the PL design reset. The time does not depend on the key, so a fixed key is used.
+*********************************************************************************************************/
+void autoselect_calibration()
+{
+	struct NESSIEstruct subkeys;
+	struct khazad_hal_ctx ctx;
+	u8 key[KEYSIZEB], IV[BLOCKSIZEB];
+	u32 i, mode;
+
+	for (i=0; i < KEYSIZEB; i++)
+		key[i] = (u8)i;
+	for (i=0; i < BLOCKSIZEB; i++)
+		IV[i] = (u8)(0xF0 - i);
+	for (i=0; i < BENCH_BLOCKS*BLOCKSIZEB; i++)
+		bench_out[i] = (u8)(7*i + 1);
+	NESSIEkeysetup(key, &subkeys);
+	khazad_hal_ctx_init(&ctx, key, IV);
+	khazad_wait(PL_queue.submitted); // the PL runs one operation at a time
+	khazad_autoselect_calibrate(&PL_select, &subkeys, &ctx, bench_out, BENCH_BLOCKS);
+
+	xil_printf("HW/SW selection calibrated, the PL design is used from (data blocks):");
+	for (mode=0; mode < AUTOSELECT_MODES; mode++)
+		xil_printf(" %u", PL_select.crossover[mode]);
+	xil_printf(" (ECB enc, ECB dec, CBC enc, CBC dec; 0: never) \n\r");
+}
+
+
+/********************************************************************************************************
+  38. Zynq_crypt_auto: encrypts or decrypts a buffer of whole data blocks by the faster of the PL design 
+  (Zynq_crypt_blocks) and the software engine, for the mode and the size of the request, by the selection 
+  table of autoselect_calibration. Before the calibration all the requests go to the PL.
+  Jobs submitted by khazad_submit are completed first.
+  subkeys: pointer to the expanded key (NESSIEkeysetup), for the software engine.
+  ctx: pointer to the same key and the IV, for the PL (khazad_hal_ctx_init). In CBC mode ctx->IV is updated to 
+  the last ciphertext block by both paths, so the blocks of a long message may take different paths.
+  in: pointer to the u8 input array.
+  out: pointer to the u8 output array (may be in).
+  nblocks: number of data blocks.
+  op_mode: flag to the desired cryptographic mode of operation. 1: CBC. 0: ECB.
+  enc_dec: flag to the desired operation.						1: encryption. 0: decryption.
+*********************************************************************************************************/
+void Zynq_crypt_auto(const struct NESSIEstruct * const subkeys, struct khazad_hal_ctx * const ctx, const u8 * const in, u8 * const out, const u32 nblocks, const bool op_mode, const bool enc_dec)
+{
+	khazad_wait(PL_queue.submitted); // the PL runs one operation at a time
+	khazad_autoselect_crypt(&PL_select, subkeys, ctx, in, out, nblocks, op_mode, enc_dec);
+}
+
+
+/********************************************************************************************************
+  39. autoselect_report: prints the selection table of Zynq_crypt_auto: the measured times of a request 
+  (in global timer ticks) of the PL design and the software engine for each mode and size class, the selected 
+  path, and the crossover of each mode. The PL is always selected from the crossover on.
+*********************************************************************************************************/
+void autoselect_report()
+{
+	static const char *name[AUTOSELECT_MODES] = {"ECB encryption", "ECB decryption", "CBC encryption", "CBC decryption"};
+	u32 mode, c;
+
+	xil_printf("*************************************************************** \n\r");
+	xil_printf("HW/SW selection table (times per request, global timer ticks) \n\r");
+	for (mode=0; mode < AUTOSELECT_MODES; mode++)
+	{
+		xil_printf("%s: \n\r", name[mode]);
+		xil_printf("%10s %12s %12s %10s \n\r", "blocks", "PL", "software", "selected");
+		for (c=0; c < PL_select.classes; c++)
+			printf("%10u %12u %12u %10s \n\r", 1u << c, PL_select.hw_time[mode][c], PL_select.sw_time[mode][c],
+				   PL_select.use_hw[mode][c] ? "PL" : "software");
+		if (PL_select.crossover[mode])
+			xil_printf("crossover: the PL design from %u data blocks \n\r", PL_select.crossover[mode]);
+		else
+			xil_printf("crossover: none, the software engine is faster \n\r");
+	}
+	xil_printf("Routed requests: %u to the PL design, %u to the software engine \n\r", PL_select.hw_requests, PL_select.sw_requests);
+}
+
+#ifdef HAL_DONE_IRQ
+/********************************************************************************************************
+  40. PL_timeout_ISR: the SCU private timer Interrupt Service Routine.
+  The timer is started by PL_hal before every WFI sleep (khazad-hal.h), and its interrupt wakes up the core 
+  after HAL_SLEEP_TIMEOUT_US if done_IRQ doesn't come; the ready flag is then polled again.
+  Compiled with HAL_DONE_IRQ only.
+*********************************************************************************************************/
+static void PL_timeout_ISR(void *CallBackReff)
+{
+	XScuTimer_ClearInterruptStatus((XScuTimer *)CallBackReff);
+	PL_timeouts++;
+}
+#endif
+
+
+#endif
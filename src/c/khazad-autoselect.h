@@ -0,0 +1,195 @@
+#ifndef KHAZAD_AUTOSELECT_H
+#define KHAZAD_AUTOSELECT_H
+/********************************************************************************************************
+*********************************************************************************************************
+Zynq-7000 based Implementation of the KHAZAD Block Cipher
+Yossef Shitzer & Efraim Wasserman
+Jerusalem College of Technology - Lev Academic Center (JCT)
+Department of electrical and electronic engineering
+2018
+*********************************************************************************************************
+*********************************************************************************************************
+This file implements a size-aware selection between the PL design and the software engine.
+A request of a few blocks may cost less in software than the bus round trips of the PL (the key writes,
+the data writes, the ctrl write, the ready flag polling and the reads of every block), while for long
+messages the PL wins. khazad_autoselect_calibrate measures both paths once (at startup), for each mode and
+each message size class, and khazad_autoselect_crypt sends every request to the faster path of its class:
+	modes - ECB encryption, ECB decryption, CBC encryption, CBC decryption (AUTOSELECT_MODES)
+	size classes - class c holds the messages of 2^(c-1) + 1 .. 2^c blocks (class 0: one block);
+			the last class, AUTOSELECT_CLASSES - 1, holds all the longer messages.
+	PL path - khazad_hal_crypt_blocks ("khazad-hal.h"), timed with the key resident in the PL (the key reload
+			elision skips the key writes and the key schedule, as for the repeated requests of a session).
+	software path - the interleaved multi-block functions of "khazad-tweak64.h" (CBC encryption block by block),
+			timed with the expanded key.
+So neither path is charged a key setup: the table compares the per-request costs of a loaded key.
+The measured times (per request of 2^c blocks) and the selection of each class are kept in the table, and
+crossover[mode] is the smallest message (in blocks) from which the PL is faster for all the larger classes
+(0 if the software engine is faster for the longest class), for inspection.
+Usage:
+	struct khazad_autoselect select;
+	khazad_autoselect_init(&select, &hal, now);
+	khazad_autoselect_calibrate(&select, &subkeys, &ctx, buffer, buffer_blocks);
+	khazad_autoselect_crypt(&select, &subkeys, &ctx, in, out, nblocks, op_mode, enc_dec);
+	select.crossover[AUTOSELECT_MODE(op_mode, enc_dec)] ...
+*********************************************************************************************************
+*********************************************************************************************************/
+
+#include <string.h>
+#include <stdbool.h>
+#include "nessie_modified.h"
+#include "khazad-tweak64.h"
+#include "khazad-hal.h"
+
+#define AUTOSELECT_MODES  4
+// size classes: 1, 2, 4, ..., 2^(AUTOSELECT_CLASSES - 1) blocks:
+#ifndef AUTOSELECT_CLASSES
+#define AUTOSELECT_CLASSES  13
+#endif
+// minimal number of blocks timed for a class (short classes are repeated):
+#ifndef AUTOSELECT_MIN_BLOCKS
+#define AUTOSELECT_MIN_BLOCKS  64
+#endif
+
+// the table index of a mode: 0 ECB encryption, 1 ECB decryption, 2 CBC encryption, 3 CBC decryption:
+#define AUTOSELECT_MODE(op_mode, enc_dec)  (2*(op_mode) + !(enc_dec))
+
+struct khazad_autoselect {
+	struct khazad_hal *hal;
+	u64 (*now)(void);  // time source (any unit: global timer ticks, nanoseconds...)
+	u32 classes;  // calibrated classes (the longer messages use the last one)
+	u32 hw_time[AUTOSELECT_MODES][AUTOSELECT_CLASSES];  // time of a PL request of 2^c blocks
+	u32 sw_time[AUTOSELECT_MODES][AUTOSELECT_CLASSES];  // time of a software request of 2^c blocks
+	bool use_hw[AUTOSELECT_MODES][AUTOSELECT_CLASSES];  // the selected path
+	u32 crossover[AUTOSELECT_MODES];  // blocks from which the PL is selected (0: never)
+	u32 hw_requests, sw_requests;  // routed requests
+};
+
+
+/**
+ * Initialize the selection on a HAL. Before the calibration, all the requests go to the PL.
+ *
+ * @param	now	the time source of khazad_autoselect_calibrate.
+ */
+void khazad_autoselect_init(struct khazad_autoselect *select, struct khazad_hal *hal, u64 (*now)(void)) {
+	memset(select, 0, sizeof(*select));
+	select->hal = hal;
+	select->now = now;
+}
+
+/**
+ * The size class of a message.
+ */
+static inline u32 autoselect_class(const struct khazad_autoselect *select, const u32 nblocks) {
+	u32 c = 0;
+
+	while (c + 1 < select->classes && ((u32)1 << c) < nblocks)
+		c++;
+	return c;
+}
+
+/*
+ * The software path, with the same interface as khazad_hal_crypt_blocks (ctx->IV: the CBC chaining value).
+ */
+static void autoselect_sw(const struct NESSIEstruct * const subkeys, struct khazad_hal_ctx *ctx, const u8 *in, u8 *out,
+						  const u32 nblocks, const bool op_mode, const bool enc_dec) {
+	u8 chain[BLOCKSIZEB];
+	u32 i;
+	int k;
+
+	if (!op_mode) {
+		if (enc_dec)
+			NESSIEencrypt_blocks(subkeys, in, out, nblocks);
+		else
+			NESSIEdecrypt_blocks(subkeys, in, out, nblocks);
+		return;
+	}
+
+	hal_store32(chain, ctx->IV[0]);
+	hal_store32(chain + 4, ctx->IV[1]);
+	if (enc_dec)
+		for (i = 0; i < nblocks; i++, in += BLOCKSIZEB, out += BLOCKSIZEB) {
+			for (k = 0; k < BLOCKSIZEB; k++)
+				chain[k] ^= in[k];
+			NESSIEencrypt64(subkeys, chain, chain);
+			memcpy(out, chain, BLOCKSIZEB);
+		}
+	else
+		NESSIEdecrypt_CBC_blocks(subkeys, in, chain, out, nblocks);
+	ctx->IV[0] = hal_load32(chain);
+	ctx->IV[1] = hal_load32(chain + 4);
+}
+
+/**
+ * Measure both paths for each mode and size class, and fill the selection table and the crossovers.
+ * The key is loaded into the PL by an untimed request first (with the key reload elision enabled for the
+ * calibration), so the PL, as the software engine, is timed without a key setup.
+ *
+ * @param	subkeys			the expanded key (from NESSIEkeysetup), for the software engine.
+ * @param	ctx				the same key, for the PL.
+ * @param	buffer			a work buffer (its contents are overwritten).
+ * @param	buffer_blocks	the size of buffer in blocks: the classes up to this size are calibrated.
+ */
+void khazad_autoselect_calibrate(struct khazad_autoselect *select, const struct NESSIEstruct * const subkeys,
+								 const struct khazad_hal_ctx * const ctx, u8 * const buffer, const u32 buffer_blocks) {
+	struct khazad_hal_ctx session;
+	u64 start, hw, sw;
+	u32 mode, c, n, repeat, r;
+	const bool elision = select->hal->elision;
+
+	select->classes = 0;
+	while (select->classes < AUTOSELECT_CLASSES && ((u32)1 << select->classes) <= buffer_blocks)
+		select->classes++;
+
+	khazad_hal_set_elision(select->hal, 1);
+	for (mode = 0; mode < AUTOSELECT_MODES; mode++) {
+		for (c = 0; c < select->classes; c++) {
+			n = (u32)1 << c;
+			repeat = (n < AUTOSELECT_MIN_BLOCKS) ? AUTOSELECT_MIN_BLOCKS / n : 1;
+			session = *ctx;
+			khazad_hal_crypt_blocks(select->hal, &session, buffer, buffer, 1, mode >= 2, !(mode & 1));  // loads the key
+			hw = 0;
+			for (r = 0; r < repeat; r++) {
+				start = select->now();
+				khazad_hal_crypt_blocks(select->hal, &session, buffer, buffer, n, mode >= 2, !(mode & 1));
+				hw += select->now() - start;
+			}
+			start = select->now();
+			for (r = 0; r < repeat; r++)
+				autoselect_sw(subkeys, &session, buffer, buffer, n, mode >= 2, !(mode & 1));
+			sw = select->now() - start;
+			select->hw_time[mode][c] = (u32)(hw / repeat);
+			select->sw_time[mode][c] = (u32)(sw / repeat);
+			select->use_hw[mode][c] = (hw < sw);
+		}
+
+		// the crossover: the first class of the last run of PL classes:
+		select->crossover[mode] = 0;
+		for (c = select->classes; c > 0 && select->use_hw[mode][c - 1]; c--)
+			select->crossover[mode] = (c == 1) ? 1 : ((u32)1 << (c - 2)) + 1;
+	}
+	khazad_hal_set_elision(select->hal, elision);
+}
+
+/**
+ * Encrypt or decrypt a buffer of whole data blocks by the faster path of its mode and size class.
+ * The parameters are the same as of khazad_hal_crypt_blocks, with the expanded key for the software path.
+ *
+ * @param	subkeys	the expanded key (from NESSIEkeysetup).
+ * @param	ctx		the same key, and the IV (updated in CBC mode, as by khazad_hal_crypt_blocks).
+ */
+void khazad_autoselect_crypt(struct khazad_autoselect *select, const struct NESSIEstruct * const subkeys,
+							 struct khazad_hal_ctx *ctx, const u8 *in, u8 *out, const u32 nblocks,
+							 const bool op_mode, const bool enc_dec) {
+	if (nblocks == 0)
+		return;
+	if (select->classes == 0 || select->use_hw[AUTOSELECT_MODE(op_mode, enc_dec)][autoselect_class(select, nblocks)]) {
+		khazad_hal_crypt_blocks(select->hal, ctx, in, out, nblocks, op_mode, enc_dec);
+		select->hw_requests++;
+	}
+	else {
+		autoselect_sw(subkeys, ctx, in, out, nblocks, op_mode, enc_dec);
+		select->sw_requests++;
+	}
+}
+
+#endif   /* KHAZAD_AUTOSELECT_H */
@@ -0,0 +1,401 @@
+#ifndef KHAZAD_BITSLICE_H
+#define KHAZAD_BITSLICE_H
+/********************************************************************************************************
+*********************************************************************************************************
+Zynq-7000 based Implementation of the KHAZAD Block Cipher
+Yossef Shitzer & Efraim Wasserman
+Jerusalem College of Technology - Lev Academic Center (JCT)
+Department of electrical and electronic engineering
+2018
+*********************************************************************************************************
+*********************************************************************************************************
+This file implements a bitsliced software version of KHAZAD, which encrypts or decrypts BS_LANES (=64)
+independent data blocks at once, without any table lookups.
+The 64 blocks are transposed into 64 bit-planes: plane p holds bit p (of the 64-bit big-endian block value)
+of all the blocks, one block per bit (lane). Every logical operation on a plane is then applied to 64 blocks.
+The functions follow the PL design modules:
+gamma - each S-box is built from the "P" and "Q" mini-boxes gate equations (P_mini_box.v, Q_mini_box.v),
+		wired together as in S_box.v.
+theta - the multiplications by the coefficients 1,3,4,5,6,8,B,7 (poly_mult.v) are computed from
+		multiplications by 2 (xtime), which on bit-planes are only plane moves and three XORs.
+		Since the matrix H is dyadic (row i of theta.v is row 0 with the byte positions XORed with i),
+		each output byte is computed in Horner form: A0 ^ 2*(A1 ^ 2*(A2 ^ 2*A3)), where each A is a XOR
+		of input bytes, according to the bits of the coefficients.
+The round keys are expanded on the fly into all-zeros/all-ones planes.
+Since there are no table lookups and no data-dependent branches, the execution time does not depend on
+the key or the data (no cache-timing variance).
+The key schedule is shared with the reference code (NESSIEkeysetup), and the results are identical.
+CTR mode: NESSIEkeystream_bitsliced encrypts BS_LANES consecutive counter blocks in one pass, and
+NESSIEcrypt_CTR_bitsliced XORs the key stream with a buffer (the constant-time option of the CTR engine,
+"khazad-ctr.h").
+*********************************************************************************************************
+*********************************************************************************************************/
+
+#include "nessie_modified.h"
+
+// number of data blocks processed in parallel, one per bit of a u64 plane:
+#define BS_LANES  64
+
+
+/**
+ * Transpose a 64x64 bit matrix in place: bit j of m[i] is swapped with bit i of m[j].
+ * Used both to map 64 blocks to 64 bit-planes and back.
+ *
+ * @param	m	the matrix, one row per u64 word.
+ */
+static void bs_transpose(u64 m[64]) {
+	int j, k;
+	u64 mask = 0x00000000ffffffffULL, t;
+
+	for (j = 32; j != 0; j >>= 1, mask ^= (mask << j)) {
+		for (k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+			t = ((m[k] >> j) ^ m[k | j]) & mask;
+			m[k] ^= t << j;
+			m[k | j] ^= t;
+		}
+	}
+}
+
+/**
+ * P mini-box on bit-planes (same gate equations as P_mini_box.v).
+ *
+ * @param	d	the four input planes, d[0] is the least significant bit.
+ * @param	o	the four output planes.
+ */
+static void bs_P_mini_box(const u64 d[4], u64 o[4]) {
+	u64 t0, t1, t1_2, t1_3, t1_4, t2, t2_2, t2_3, t2_4, t3, t3_2, t4, t4_2, t4_3;
+
+	t0 = d[0] ^ d[1];
+	t1 = d[0] ^ d[3];
+	t2 = d[2] & t1;
+	t3 = d[3] & t1;
+	t4 = t0 | t3;
+	o[3] = t2 ^ t4;
+	t1_2 = ~t1;
+	t2_2 = d[1] & d[2];
+	t4_2 = d[3] | o[3];
+	t1_3 = t1_2 ^ t2_2;
+	o[0] = t4_2 ^ t1_3;
+	t4_3 = d[2] & t1_3;
+	t2_3 = t2_2 ^ d[3];
+	t2_4 = t2_3 | t4_3;
+	o[2] = t0 ^ t2_4;
+	t3_2 = t3 ^ t4_3;
+	t1_4 = t1_3 | o[3];
+	o[1] = t3_2 ^ t1_4;
+}
+
+/**
+ * Q mini-box on bit-planes (same gate equations as Q_mini_box.v).
+ *
+ * @param	d	the four input planes, d[0] is the least significant bit.
+ * @param	o	the four output planes.
+ */
+static void bs_Q_mini_box(const u64 d[4], u64 o[4]) {
+	u64 t0, t0_2, t0_3, t0_4, t1, t1_2, t1_3, t1_4, t1_5, t2, t3, t3_2, t3_3, t4;
+
+	t0 = ~d[0];
+	t1 = d[1] ^ d[2];
+	t2 = d[2] & t0;
+	t3 = d[3] ^ t2;
+	t4 = t1 & t3;
+	o[0] = t0 ^ t4;
+	t0_2 = d[0] ^ d[1];
+	t1_2 = t1 ^ t2;
+	t0_3 = t0_2 ^ t3;
+	t1_3 = t1_2 | t0_3;
+	o[2] = d[2] ^ t1_3;
+	t1_4 = t1_3 & d[0];
+	t3_2 = d[3] & t0_3;
+	t3_3 = t3_2 ^ t2;
+	o[1] = t1_4 ^ t3_3;
+	t1_5 = d[2] | o[0];
+	t0_4 = t0_3 ^ t3_3;
+	o[3] = t1_5 ^ t0_4;
+}
+
+/**
+ * S-box on the eight bit-planes of one byte position (same wiring as S_box.v).
+ *
+ * @param	x	the eight planes of the byte, x[0] is the least significant bit. Replaced by the result.
+ */
+static void bs_S_box(u64 x[8]) {
+	u64 in[4], p1[4], q1[4], p2[4], q2[4];
+
+	in[0] = x[4]; in[1] = x[5]; in[2] = x[6]; in[3] = x[7];
+	bs_P_mini_box(in, p1);
+	in[0] = x[0]; in[1] = x[1]; in[2] = x[2]; in[3] = x[3];
+	bs_Q_mini_box(in, q1);
+	in[0] = q1[0]; in[1] = q1[1]; in[2] = p1[0]; in[3] = p1[1];  // {p1[1:0], q1[1:0]}
+	bs_P_mini_box(in, p2);
+	in[0] = q1[2]; in[1] = q1[3]; in[2] = p1[2]; in[3] = p1[3];  // {p1[3:2], q1[3:2]}
+	bs_Q_mini_box(in, q2);
+	in[0] = p2[2]; in[1] = p2[3]; in[2] = q2[2]; in[3] = q2[3];  // {q2[3:2], p2[3:2]}
+	bs_P_mini_box(in, &x[4]);
+	in[0] = p2[0]; in[1] = p2[1]; in[2] = q2[0]; in[3] = q2[1];  // {q2[1:0], p2[1:0]}
+	bs_Q_mini_box(in, &x[0]);
+}
+
+/**
+ * Multiplication by 2 over GF(2^8) on bit-planes, with the KHAZAD reduction polynomial
+ * x^8 + x^4 + x^3 + x^2 + 1 (as the "mult2" wire of poly_mult.v).
+ *
+ * @param	x	the eight planes of the byte. Replaced by the result.
+ */
+static void bs_xtime(u64 x[8]) {
+	u64 msb = x[7];
+
+	x[7] = x[6];
+	x[6] = x[5];
+	x[5] = x[4];
+	x[4] = x[3] ^ msb;
+	x[3] = x[2] ^ msb;
+	x[2] = x[1] ^ msb;
+	x[1] = x[0];
+	x[0] = msb;
+}
+
+/**
+ * Linear diffusion layer theta on bit-planes.
+ * Output byte j = sum over d of coef[d] * x[j^d], with coef = 1,3,4,5,6,8,B,7 (row 0 of theta.v).
+ * Grouping the input bytes by the bits of the coefficients:
+ *   bit 0 (1,3,5,B,7): d = 0,1,3,6,7
+ *   bit 1 (3,6,B,7):   d = 1,4,6,7
+ *   bit 2 (4,5,6,7):   d = 2,3,4,7
+ *   bit 3 (8,B):       d = 5,6
+ * gives output byte j = A0 ^ 2*(A1 ^ 2*(A2 ^ 2*A3)).
+ *
+ * @param	in	the 64 input planes, byte position j (0 = most significant byte) at in[8*(7-j)].
+ * @param	out	the 64 output planes.
+ */
+static void bs_theta(const u64 in[64], u64 out[64]) {
+	int j, b;
+	const u64 *x0, *x1, *x2, *x3, *x4, *x5, *x6, *x7;
+	u64 *y;
+
+	for (j = 0; j < 8; j++) {
+		x0 = &in[8*(7 - (j    ))];
+		x1 = &in[8*(7 - (j ^ 1))];
+		x2 = &in[8*(7 - (j ^ 2))];
+		x3 = &in[8*(7 - (j ^ 3))];
+		x4 = &in[8*(7 - (j ^ 4))];
+		x5 = &in[8*(7 - (j ^ 5))];
+		x6 = &in[8*(7 - (j ^ 6))];
+		x7 = &in[8*(7 - (j ^ 7))];
+		y  = &out[8*(7 - j)];
+
+		for (b = 0; b < 8; b++)
+			y[b] = x5[b] ^ x6[b];						// A3
+		bs_xtime(y);
+		for (b = 0; b < 8; b++)
+			y[b] ^= x2[b] ^ x3[b] ^ x4[b] ^ x7[b];		// A2
+		bs_xtime(y);
+		for (b = 0; b < 8; b++)
+			y[b] ^= x1[b] ^ x4[b] ^ x6[b] ^ x7[b];		// A1
+		bs_xtime(y);
+		for (b = 0; b < 8; b++)
+			y[b] ^= x0[b] ^ x1[b] ^ x3[b] ^ x6[b] ^ x7[b];	// A0
+	}
+}
+
+/**
+ * Add a round key to the bit-planes: plane p is inverted in all lanes when bit p of the key is 1.
+ *
+ * @param	x			the 64 planes.
+ * @param	roundKey	the 64-bit round key, as two u32 halves.
+ */
+static void bs_add_key(u64 x[64], const u32 roundKey[2]) {
+	int p;
+
+	for (p = 0; p < 32; p++) {
+		x[p]      ^= (u64)0 - ((roundKey[1] >> p) & 1);
+		x[p + 32] ^= (u64)0 - ((roundKey[0] >> p) & 1);
+	}
+}
+
+/**
+ * Either encrypt or decrypt BS_LANES block values, according to the key schedule.
+ *
+ * @param	x			the 64-bit block values, one per lane. Replaced by the results.
+ * @param	roundKey	the key schedule to be used.
+ */
+static void bs_crypt_lanes(u64 x[64], const u32 roundKey[R + 1][2]) {
+	u64 t[64];
+	int r, j;
+
+	/*
+	 * map the blocks to bit-planes:
+	 */
+	bs_transpose(x);
+
+	/*
+	 * add initial round key, then R - 1 full rounds and the last round:
+	 */
+	bs_add_key(x, roundKey[0]);
+	for (r = 1; r <= R; r++) {
+		for (j = 0; j < 8; j++)
+			bs_S_box(&x[8*j]);  // gamma
+		if (r < R) {
+			bs_theta(x, t);
+			memcpy(x, t, sizeof(t));
+		}
+		bs_add_key(x, roundKey[r]);
+	}
+
+	/*
+	 * map bit-planes back to the blocks:
+	 */
+	bs_transpose(x);
+}
+
+/**
+ * Write the block values of the first lanes as big-endian data blocks.
+ *
+ * @param	x		the 64-bit block values, one per lane.
+ * @param	output	the data blocks.
+ * @param	blocks	number of blocks, 1 to BS_LANES.
+ */
+static void bs_store_lanes(const u64 x[64], u8 *output, const u32 blocks) {
+	u32 k;
+
+	for (k = 0; k < blocks; k++) {
+		u8 *block = output + BLOCKSIZEB*k;
+		block[0] = (u8)(x[k] >> 56);
+		block[1] = (u8)(x[k] >> 48);
+		block[2] = (u8)(x[k] >> 40);
+		block[3] = (u8)(x[k] >> 32);
+		block[4] = (u8)(x[k] >> 24);
+		block[5] = (u8)(x[k] >> 16);
+		block[6] = (u8)(x[k] >>  8);
+		block[7] = (u8)(x[k]      );
+	}
+}
+
+/**
+ * Either encrypt or decrypt up to BS_LANES data blocks, according to the key schedule.
+ *
+ * @param	input		the data blocks to be encrypted/decrypted.
+ * @param	output		the resulting data blocks.
+ * @param	blocks		number of blocks, 1 to BS_LANES.
+ * @param	roundKey	the key schedule to be used.
+ */
+static void bs_crypt(const u8 *input, u8 *output, const u32 blocks,
+					 const u32 roundKey[R + 1][2]) {
+	u64 x[64];
+	u32 k;
+
+	for (k = 0; k < BS_LANES; k++) {
+		if (k < blocks) {
+			const u8 *block = input + BLOCKSIZEB*k;
+			x[k] =
+				((u64)block[0] << 56) ^
+				((u64)block[1] << 48) ^
+				((u64)block[2] << 40) ^
+				((u64)block[3] << 32) ^
+				((u64)block[4] << 24) ^
+				((u64)block[5] << 16) ^
+				((u64)block[6] <<  8) ^
+				((u64)block[7]      );
+		}
+		else
+			x[k] = 0;  // unused lane
+	}
+	bs_crypt_lanes(x, roundKey);
+	bs_store_lanes(x, output, blocks);
+}
+
+/**
+ * Encrypt a buffer of data blocks with the bitsliced implementation (ECB).
+ * The blocks are processed BS_LANES at a time; the last group may be partial.
+ *
+ * @param	structpointer	the expanded key (from NESSIEkeysetup).
+ * @param	plaintext		the data blocks to be encrypted.
+ * @param	ciphertext		the encrypted data blocks (may be the same buffer as plaintext).
+ * @param	blocks			number of data blocks.
+ */
+void NESSIEencrypt_bitsliced(const struct NESSIEstruct * const structpointer,
+							 const u8 * const plaintext,
+							       u8 * const ciphertext,
+							 const u32 blocks) {
+	u32 i;
+
+	for (i = 0; i < blocks; i += BS_LANES)
+		bs_crypt(plaintext + BLOCKSIZEB*i, ciphertext + BLOCKSIZEB*i,
+				 (blocks - i < BS_LANES) ? blocks - i : BS_LANES, structpointer->roundKeyEnc);
+}
+
+/**
+ * Decrypt a buffer of data blocks with the bitsliced implementation (ECB).
+ * The blocks are processed BS_LANES at a time; the last group may be partial.
+ *
+ * @param	structpointer	the expanded key (from NESSIEkeysetup).
+ * @param	ciphertext		the data blocks to be decrypted.
+ * @param	plaintext		the decrypted data blocks (may be the same buffer as ciphertext).
+ * @param	blocks			number of data blocks.
+ */
+void NESSIEdecrypt_bitsliced(const struct NESSIEstruct * const structpointer,
+							 const u8 * const ciphertext,
+							       u8 * const plaintext,
+							 const u32 blocks) {
+	u32 i;
+
+	for (i = 0; i < blocks; i += BS_LANES)
+		bs_crypt(ciphertext + BLOCKSIZEB*i, plaintext + BLOCKSIZEB*i,
+				 (blocks - i < BS_LANES) ? blocks - i : BS_LANES, structpointer->roundKeyDec);
+}
+
+/**
+ * Generate the CTR mode key stream of BS_LANES consecutive counter blocks in one pass:
+ * E(counter), E(counter + 1), ... (the counter block is a 64-bit big-endian integer, modulo 2^64).
+ * All the lanes are encrypted, so the time does not depend on blocks either.
+ *
+ * @param	structpointer	the expanded key (from NESSIEkeysetup).
+ * @param	counter			the counter value of the first block.
+ * @param	stream			the key stream blocks.
+ * @param	blocks			number of key stream blocks written, 1 to BS_LANES.
+ */
+void NESSIEkeystream_bitsliced(const struct NESSIEstruct * const structpointer, const u64 counter,
+							   u8 * const stream, const u32 blocks) {
+	u64 x[64];
+	u32 k;
+
+	for (k = 0; k < BS_LANES; k++)
+		x[k] = counter + k;
+	bs_crypt_lanes(x, structpointer->roundKeyEnc);
+	bs_store_lanes(x, stream, blocks);
+}
+
+/**
+ * CTR mode encryption (or decryption, which is the same operation) of a buffer of data blocks, with the
+ * bitsliced key stream (BS_LANES counter blocks per pass).
+ *
+ * @param	structpointer	the expanded key (from NESSIEkeysetup).
+ * @param	counter			the counter block (64-bit big-endian) of the first data block.
+ * 							Updated to the counter block of the next data block, for the next call.
+ * @param	input			the data blocks (plaintext or ciphertext).
+ * @param	output			the resulting data blocks (may be the same buffer as input).
+ * @param	blocks			number of data blocks.
+ */
+void NESSIEcrypt_CTR_bitsliced(const struct NESSIEstruct * const structpointer,
+							         u8 * const counter,
+							   const u8 * const input,
+							         u8 * const output,
+							   const u32 blocks) {
+	u8 stream[BS_LANES*BLOCKSIZEB];
+	u64 ctr = 0;
+	u32 i, n, k;
+
+	for (k = 0; k < BLOCKSIZEB; k++)
+		ctr = (ctr << 8) ^ counter[k];
+	for (i = 0; i < blocks; i += n) {
+		n = (blocks - i < BS_LANES) ? blocks - i : BS_LANES;
+		NESSIEkeystream_bitsliced(structpointer, ctr + i, stream, n);
+		for (k = 0; k < BLOCKSIZEB*n; k++)
+			output[BLOCKSIZEB*i + k] = input[BLOCKSIZEB*i + k] ^ stream[k];
+	}
+	ctr += blocks;
+	for (k = BLOCKSIZEB; k != 0; k--, ctr >>= 8)
+		counter[k - 1] = (u8)ctr;
+}
+
+#endif   /* KHAZAD_BITSLICE_H */
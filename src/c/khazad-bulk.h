@@ -0,0 +1,228 @@
+#ifndef KHAZAD_BULK_H
+#define KHAZAD_BULK_H
+/********************************************************************************************************
+*********************************************************************************************************
+Zynq-7000 based Implementation of the KHAZAD Block Cipher
+Yossef Shitzer & Efraim Wasserman
+Jerusalem College of Technology - Lev Academic Center (JCT)
+Department of electrical and electronic engineering
+2018
+*********************************************************************************************************
+*********************************************************************************************************
+This file implements software operations on large buffers of data blocks.
+NESSIEdecrypt_CBC_bulk - CBC decryption of a whole buffer. Unlike CBC encryption, CBC decryption has no
+		serial dependency: every block is decrypted independently, and then XORed with the previous
+		ciphertext block. The buffer is processed in chunks of BULK_CHUNK_BLOCKS (small enough to stay in the
+		L1 data cache): each chunk is decrypted by the interleaved multi-block function NESSIEdecrypt_blocks
+		("khazad-tweak64.h"), and then the chaining XOR is done in one pass over the chunk,
+		which the compiler vectorizes (NEON / SSE).
+		When KHAZAD_LINUX is defined, large buffers are split between up to BULK_THREADS POSIX threads.
+		The chaining value of every part is the last ciphertext block of the previous part,
+		so the parts are decrypted independently.
+NESSIEcrypt_CTR_bulk - CTR mode encryption/decryption of a whole buffer. The counter block is a 64-bit big-endian
+		integer, incremented for every data block. The key stream of each chunk is generated by
+		NESSIEencrypt_blocks, and then XORed with the data in one pass.
+*********************************************************************************************************
+*********************************************************************************************************/
+
+#include <string.h>
+#include "nessie_modified.h"
+#include "khazad-tweak64.h"
+#ifdef KHAZAD_LINUX
+#include <stdbool.h>
+#include <pthread.h>
+#endif
+
+// number of data blocks decrypted before each chaining XOR pass (4 KB):
+#ifndef BULK_CHUNK_BLOCKS
+#define BULK_CHUNK_BLOCKS  512
+#endif
+
+#ifdef KHAZAD_LINUX
+// maximal number of threads for one buffer:
+#ifndef BULK_THREADS
+#define BULK_THREADS  4
+#endif
+// minimal number of data blocks per thread (smaller buffers are not worth the thread creation):
+#ifndef BULK_THREAD_MIN_BLOCKS
+#define BULK_THREAD_MIN_BLOCKS  8192
+#endif
+#endif
+
+
+/**
+ * CBC chaining pass: XOR each decrypted block with the previous ciphertext block.
+ *
+ * @param	plaintext	the decrypted (ECB) data blocks. Replaced by the CBC plaintext.
+ * @param	ciphertext	the ciphertext data blocks (must not overlap plaintext).
+ * @param	CBC_Xor		the chaining value of the first block.
+ * @param	blocks		number of data blocks.
+ */
+static void bulk_cbc_xor(u8 * restrict plaintext, const u8 * restrict ciphertext,
+						 const u8 *CBC_Xor, const u32 blocks) {
+	u32 i;
+
+	if (blocks == 0)
+		return;
+	for (i = 0; i < BLOCKSIZEB; i++)
+		plaintext[i] ^= CBC_Xor[i];
+	for (i = BLOCKSIZEB; i < BLOCKSIZEB*blocks; i++)  // vectorized by the compiler
+		plaintext[i] ^= ciphertext[i - BLOCKSIZEB];
+}
+
+/**
+ * CBC decryption of a buffer in the calling thread.
+ *
+ * @param	structpointer	the expanded key (from NESSIEkeysetup).
+ * @param	ciphertext		the data blocks to be decrypted.
+ * @param	CBC_Xor			the chaining value of the first block (not updated).
+ * @param	plaintext		the decrypted data blocks (either the same buffer as ciphertext, or not overlapping it).
+ * @param	blocks			number of data blocks.
+ */
+static void bulk_cbc_decrypt(const struct NESSIEstruct * const structpointer,
+							 const u8 *ciphertext, const u8 *CBC_Xor, u8 *plaintext, const u32 blocks) {
+	u8 chain[BLOCKSIZEB];
+	u32 i, n;
+
+	if (plaintext == ciphertext) {
+		// in place: the ciphertext is overwritten, so decryption and chaining are done in one pass
+		memcpy(chain, CBC_Xor, BLOCKSIZEB);
+		NESSIEdecrypt_CBC_blocks(structpointer, ciphertext, chain, plaintext, blocks);
+		return;
+	}
+
+	for (i = 0; i < blocks; i += n) {
+		n = (blocks - i < BULK_CHUNK_BLOCKS) ? blocks - i : BULK_CHUNK_BLOCKS;
+		NESSIEdecrypt_blocks(structpointer, ciphertext + BLOCKSIZEB*i, plaintext + BLOCKSIZEB*i, n);
+		bulk_cbc_xor(plaintext + BLOCKSIZEB*i, ciphertext + BLOCKSIZEB*i,
+					 i ? ciphertext + BLOCKSIZEB*(i - 1) : CBC_Xor, n);
+	}
+}
+
+#ifdef KHAZAD_LINUX
+// one part of a buffer, decrypted by one thread:
+struct bulk_cbc_job {
+	const struct NESSIEstruct *structpointer;
+	const u8 *ciphertext;
+	u8 *plaintext;
+	u8 chain[BLOCKSIZEB];
+	u32 blocks;
+};
+
+static void *bulk_cbc_thread(void *arg) {
+	struct bulk_cbc_job *job = (struct bulk_cbc_job *)arg;
+
+	bulk_cbc_decrypt(job->structpointer, job->ciphertext, job->chain, job->plaintext, job->blocks);
+	return NULL;
+}
+#endif
+
+/**
+ * CBC decryption of a whole buffer of data blocks.
+ *
+ * @param	structpointer	the expanded key (from NESSIEkeysetup).
+ * @param	ciphertext		the data blocks to be decrypted.
+ * @param	CBC_Xor			the IV, or the last ciphertext block of the previous buffer.
+ * 							Updated to the last ciphertext block of this buffer, for chaining the next call.
+ * @param	plaintext		the decrypted data blocks (either the same buffer as ciphertext, or not overlapping it).
+ * @param	blocks			number of data blocks.
+ */
+void NESSIEdecrypt_CBC_bulk(const struct NESSIEstruct * const structpointer,
+							const u8 * const ciphertext,
+							      u8 * const CBC_Xor,
+							      u8 * const plaintext,
+							const u32 blocks) {
+	u8 last[BLOCKSIZEB];
+
+	if (blocks == 0)
+		return;
+	memcpy(last, ciphertext + BLOCKSIZEB*(blocks - 1), BLOCKSIZEB);  // before it may be overwritten (in place)
+
+#ifdef KHAZAD_LINUX
+	if (blocks >= 2*BULK_THREAD_MIN_BLOCKS) {
+		struct bulk_cbc_job job[BULK_THREADS];
+		pthread_t thread[BULK_THREADS];
+		bool created[BULK_THREADS];
+		u32 threads, first, t;
+
+		threads = blocks / BULK_THREAD_MIN_BLOCKS;
+		if (threads > BULK_THREADS)
+			threads = BULK_THREADS;
+
+		// take all the chaining values before any thread writes the plaintext:
+		for (t = 0, first = 0; t < threads; t++) {
+			job[t].structpointer = structpointer;
+			job[t].ciphertext = ciphertext + BLOCKSIZEB*first;
+			job[t].plaintext = plaintext + BLOCKSIZEB*first;
+			job[t].blocks = blocks / threads + (t < blocks % threads);
+			memcpy(job[t].chain, first ? ciphertext + BLOCKSIZEB*(first - 1) : CBC_Xor, BLOCKSIZEB);
+			first += job[t].blocks;
+		}
+
+		for (t = 1; t < threads; t++)
+			created[t] = (pthread_create(&thread[t], NULL, bulk_cbc_thread, &job[t]) == 0);
+		bulk_cbc_thread(&job[0]);  // the first part in the calling thread
+		for (t = 1; t < threads; t++) {
+			if (created[t])
+				pthread_join(thread[t], NULL);
+			else
+				bulk_cbc_thread(&job[t]);  // thread creation failed: decrypt this part here
+		}
+
+		memcpy(CBC_Xor, last, BLOCKSIZEB);
+		return;
+	}
+#endif
+
+	bulk_cbc_decrypt(structpointer, ciphertext, CBC_Xor, plaintext, blocks);
+	memcpy(CBC_Xor, last, BLOCKSIZEB);
+}
+
+/**
+ * CTR mode key stream XOR for one chunk: data ^= E(counter), E(counter+1), ...
+ *
+ * @param	structpointer	the expanded key (from NESSIEkeysetup).
+ * @param	counter			the counter value of the first block.
+ * @param	input			the data blocks (plaintext or ciphertext).
+ * @param	output			the resulting data blocks (may be the same buffer as input).
+ * @param	blocks			number of data blocks, 1 to BULK_CHUNK_BLOCKS.
+ */
+static void bulk_ctr_chunk(const struct NESSIEstruct * const structpointer, u64 counter,
+						   const u8 *input, u8 *output, const u32 blocks) {
+	u8 stream[BULK_CHUNK_BLOCKS*BLOCKSIZEB];
+	u32 i = 0;
+
+	do  // blocks >= 1: the first counter block is always written (so GCC sees stream initialized)
+		U64TO8_BIG(stream + BLOCKSIZEB*i, counter + i);
+	while (++i < blocks);
+	NESSIEencrypt_blocks(structpointer, stream, stream, blocks);
+	for (i = 0; i < BLOCKSIZEB*blocks; i++)  // vectorized by the compiler
+		output[i] = input[i] ^ stream[i];
+}
+
+/**
+ * CTR mode encryption (or decryption, which is the same operation) of a whole buffer of data blocks.
+ *
+ * @param	structpointer	the expanded key (from NESSIEkeysetup).
+ * @param	counter			the counter block (64-bit big-endian) of the first data block.
+ * 							Updated to the counter block of the next data block, for the next call.
+ * @param	input			the data blocks (plaintext or ciphertext).
+ * @param	output			the resulting data blocks (may be the same buffer as input).
+ * @param	blocks			number of data blocks.
+ */
+void NESSIEcrypt_CTR_bulk(const struct NESSIEstruct * const structpointer,
+						        u8 * const counter,
+						  const u8 * const input,
+						        u8 * const output,
+						  const u32 blocks) {
+	u64 ctr = U8TO64_BIG(counter);
+	u32 i, n;
+
+	for (i = 0; i < blocks; i += n) {
+		n = (blocks - i < BULK_CHUNK_BLOCKS) ? blocks - i : BULK_CHUNK_BLOCKS;
+		bulk_ctr_chunk(structpointer, ctr + i, input + BLOCKSIZEB*i, output + BLOCKSIZEB*i, n);
+	}
+	U64TO8_BIG(counter, ctr + blocks);
+}
+
+#endif   /* KHAZAD_BULK_H */
@@ -0,0 +1,163 @@
+#ifndef KHAZAD_CCM_H
+#define KHAZAD_CCM_H
+/********************************************************************************************************
+*********************************************************************************************************
+Zynq-7000 based Implementation of the KHAZAD Block Cipher
+Yossef Shitzer & Efraim Wasserman
+Jerusalem College of Technology - Lev Academic Center (JCT)
+Department of electrical and electronic engineering
+2018
+*********************************************************************************************************
+*********************************************************************************************************
+This file implements a single-pass authenticated encryption mode in the style of CCM (NIST SP 800-38C):
+CTR mode encryption, and a CBC-MAC of the plaintext, with the same key.
+CCM formatting is defined for 128-bit blocks, so the 64-bit blocks here are formatted as:
+	counter block A_i = nonce (32 bits) || 0 || i (31 bits)
+	first MAC block B0 = nonce (32 bits) || 1 || message length in bytes (31 bits)
+The message is encrypted with the key stream E(A_1), E(A_2), ... (the same as NESSIEcrypt_CTR_bulk from
+the counter block nonce || 00000001), the CBC-MAC starts with B0 and then the zero padded plaintext,
+and the tag is the CBC-MAC XOR E(A_0).
+Every input block is read once, and each loop iteration runs two independent encryptions together
+(the CBC-MAC of block i and the key stream of block i+1), interleaved round by round,
+so the two dependency chains overlap in the pipeline.
+A nonce must never be used twice with the same key.
+The length field of B0 has 31 bits, so longer messages are rejected: above CCM_MAX_LENGTH the MAC flag would be
+cleared, and B0 would be a counter block (for 2^31 bytes, A_0: the CBC-MAC would start with the tag mask).
+Usage:
+	if (khazad_ccm_encrypt(&subkeys, nonce, plaintext, ciphertext, length, tag) != 0)
+		...	// too long
+	if (khazad_ccm_decrypt(&subkeys, nonce, ciphertext, plaintext, length, tag) != 0)
+		...	// not authentic, the plaintext is erased
+*********************************************************************************************************
+*********************************************************************************************************/
+
+#include <string.h>
+#include "nessie_modified.h"
+#include "khazad-tweak64.h"
+#include "khazad-keyagile.h"
+
+// size of the nonce and of the tag in bytes:
+#define CCM_NONCEB  4
+#define CCM_TAGB    BLOCKSIZEB
+
+// maximal message length in bytes (31 bits, the length field of B0):
+#define CCM_MAX_LENGTH  0x7FFFFFFFU
+
+#define CCM_MAC_FLAG  0x80000000ULL
+
+
+/**
+ * Encrypt two independent blocks, interleaving their rounds.
+ */
+static inline void ccm_encrypt2(u64 *a, u64 *b, const u64 K[R + 1]) {
+	u64 x = *a ^ K[0], y = *b ^ K[0];
+	int r;
+
+	for (r = 1; r < R; r++) {
+		x = keyagile_round(x) ^ K[r];
+		y = keyagile_round(y) ^ K[r];
+	}
+	*a = keyagile_last_round(x) ^ K[R];
+	*b = keyagile_last_round(y) ^ K[R];
+}
+
+/**
+ * Load a partial data block, zero padded.
+ */
+static inline u64 ccm_load(const u8 *in, const u32 n) {
+	u8 block[BLOCKSIZEB] = {0};
+
+	memcpy(block, in, n);
+	return U8TO64_BIG(block);
+}
+
+/**
+ * Encrypt or decrypt a message, and compute its tag, in one pass.
+ * Block k (1..n): the data is XORed with the key stream E(A_k) computed in the previous iteration,
+ * and the iteration encrypts the CBC-MAC of the plaintext block together with the next counter block
+ * (A_{k+1}, or A_0 after the last block).
+ */
+static void ccm_crypt(const struct NESSIEstruct * const structpointer, const u8 * const nonce,
+					  const u8 *input, u8 *output, const u32 length, const int encrypt, u8 * const tag) {
+	u64 K[R + 1], base, mac, stream, p, c;
+	u32 n = (length + BLOCKSIZEB - 1)/BLOCKSIZEB, k, m, j;
+	int r;
+
+	for (r = 0; r <= R; r++)
+		K[r] = ((u64)structpointer->roundKeyEnc[r][0] << 32) ^ structpointer->roundKeyEnc[r][1];
+	base = ((u64)nonce[0] << 56) ^ ((u64)nonce[1] << 48) ^ ((u64)nonce[2] << 40) ^ ((u64)nonce[3] << 32);
+
+	mac = base ^ CCM_MAC_FLAG ^ length;  // B0
+	stream = (n == 0) ? base : base + 1;  // A_1, or A_0 for an empty message
+	ccm_encrypt2(&mac, &stream, K);
+
+	for (k = 1; k <= n; k++, input += BLOCKSIZEB, output += BLOCKSIZEB) {
+		m = (k < n || length % BLOCKSIZEB == 0) ? BLOCKSIZEB : length % BLOCKSIZEB;
+		if (m == BLOCKSIZEB) {
+			c = U8TO64_BIG(input) ^ stream;
+			p = encrypt ? U8TO64_BIG(input) : c;
+			U64TO8_BIG(output, c);
+		}
+		else {  // the last partial block: only m bytes of the key stream are used
+			c = (ccm_load(input, m) ^ stream) & ~(~0ULL >> (8*m));
+			p = encrypt ? ccm_load(input, m) : c;
+			for (j = 0; j < m; j++)
+				output[j] = (u8)(c >> (56 - 8*j));
+		}
+		mac ^= p;
+		stream = (k < n) ? base + k + 1 : base;  // A_{k+1}, or A_0
+		ccm_encrypt2(&mac, &stream, K);
+	}
+
+	U64TO8_BIG(tag, mac ^ stream);  // CBC-MAC ^ E(A_0)
+}
+
+/**
+ * Encrypt a message and compute its authentication tag.
+ *
+ * @param	structpointer	the expanded key (from NESSIEkeysetup or NESSIEkeysetup_encrypt).
+ * @param	nonce			CCM_NONCEB bytes, unique for every message of the key.
+ * @param	plaintext		the message.
+ * @param	ciphertext		the encrypted message, of the same length (may be the same buffer as plaintext).
+ * @param	length			number of bytes, up to CCM_MAX_LENGTH.
+ * @param	tag				the authentication tag (CCM_TAGB bytes).
+ * @return	0, or -1 if length is above CCM_MAX_LENGTH (nothing is encrypted).
+ */
+int khazad_ccm_encrypt(const struct NESSIEstruct * const structpointer, const u8 * const nonce,
+					   const u8 * const plaintext, u8 * const ciphertext, const u32 length, u8 * const tag) {
+	if (length > CCM_MAX_LENGTH)
+		return -1;
+	ccm_crypt(structpointer, nonce, plaintext, ciphertext, length, 1, tag);
+	return 0;
+}
+
+/**
+ * Decrypt a message and verify its authentication tag.
+ *
+ * @param	structpointer	the expanded key (from NESSIEkeysetup or NESSIEkeysetup_encrypt).
+ * @param	nonce			the nonce of the message.
+ * @param	ciphertext		the encrypted message.
+ * @param	plaintext		the decrypted message (may be the same buffer as ciphertext).
+ * @param	length			number of bytes, up to CCM_MAX_LENGTH.
+ * @param	tag				the received authentication tag (CCM_TAGB bytes).
+ * @return	0 if the message is authentic, -1 if not (the plaintext is then erased), or if length is above
+ * 			CCM_MAX_LENGTH (nothing is decrypted).
+ */
+int khazad_ccm_decrypt(const struct NESSIEstruct * const structpointer, const u8 * const nonce,
+					   const u8 * const ciphertext, u8 * const plaintext, const u32 length, const u8 * const tag) {
+	u8 expected[CCM_TAGB], diff = 0;
+	int i;
+
+	if (length > CCM_MAX_LENGTH)
+		return -1;
+	ccm_crypt(structpointer, nonce, ciphertext, plaintext, length, 0, expected);
+	for (i = 0; i < CCM_TAGB; i++)  // constant time comparison
+		diff |= expected[i] ^ tag[i];
+	if (diff) {
+		memset(plaintext, 0, length);
+		return -1;
+	}
+	return 0;
+}
+
+#endif   /* KHAZAD_CCM_H */
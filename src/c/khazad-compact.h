@@ -0,0 +1,215 @@
+#ifndef KHAZAD_COMPACT_H
+#define KHAZAD_COMPACT_H
+/********************************************************************************************************
+*********************************************************************************************************
+Zynq-7000 based Implementation of the KHAZAD Block Cipher
+Yossef Shitzer & Efraim Wasserman
+Jerusalem College of Technology - Lev Academic Center (JCT)
+Department of electrical and electronic engineering
+2018
+*********************************************************************************************************
+*********************************************************************************************************
+This file implements a small-footprint software version of KHAZAD, with a single 2 KB table
+(instead of the 16 KB of T0..T7 in "khazad-tweak64.h", or of U0..V7 in "khazad-tweak32.h"), 
+so the table stays resident in the L1 data cache of the Cortex-A9 (32 KB) together with the application data.
+The matrix H is dyadic (see theta.v: row 0 is 134568b7, row 1 is 3154867b, ...): H[i][j] = H[0][i^j].
+Therefore T_i[x] is T0[x] with byte j moved to position j^i, which is a composition of three byte swaps:
+	bit 0 of i - swap adjacent bytes  (compact_swap8)
+	bit 1 of i - swap 16-bit halves   (compact_swap16)
+	bit 2 of i - swap 32-bit halves   (compact_swap32, free on a 32-bit processor)
+The swaps are linear, so a round is computed with 7 swaps:
+	a0 ^ sw8(a1) ^ sw16(a2 ^ sw8(a3)) ^ sw32(a4 ^ sw8(a5) ^ sw16(a6 ^ sw8(a7))),  a_i = C0[byte i of the state].
+Byte 0 of C0[x] is S[x] (H[0][0] = 1), which is used in the last round.
+The key schedule is shared with the reference code (NESSIEkeysetup), and the results are identical.
+*********************************************************************************************************
+*********************************************************************************************************/
+
+#include "nessie_modified.h"
+
+/*
+ * The table is listed in BIG-ENDIAN format, as in the reference code.
+ * C0[x] = S[x] * row 0 of H (it is the same as T0 of "khazad-tweak64.h").
+ */
+
+static const u64 C0[256] = {
+    0xbad3d268bbb96a01ULL, 0x54fc4d19e59a66b1ULL, 0x2f71bc93e26514cdULL, 0x749ccdb925871b51ULL,
+    0x53f55102f7a257a4ULL, 0xd3686bb8d0d6be03ULL, 0xd26b6fbdd6deb504ULL, 0x4dd72964b35285feULL,
+    0x50f05d0dfdba4aadULL, 0xace98a26cf09e063ULL, 0x8d8a0e83091c9684ULL, 0xbfdcc679a5914d1aULL,
+    0x7090ddad3da7374dULL, 0x52f65507f1aa5ca3ULL, 0x9ab352c87ba417e1ULL, 0x4cd42d61b55a8ef9ULL,
+    0xea238f65460320acULL, 0xd56273a6c4e68411ULL, 0x97a466f155cc68c2ULL, 0xd16e63b2dcc6a80dULL,
+    0x3355ccffaa85d099ULL, 0x51f35908fbb241aaULL, 0x5bed712ac7e20f9cULL, 0xa6f7a204f359ae55ULL,
+    0xde7f5f81febec120ULL, 0x48d83d75ad7aa2e5ULL, 0xa8e59a32d729cc7fULL, 0x99b65ec771bc0ae8ULL,
+    0xdb704b90e096e63bULL, 0x3256c8faac8ddb9eULL, 0xb7c4e65195d11522ULL, 0xfc19d72b32b3aaceULL,
+    0xe338ab48704b7393ULL, 0x9ebf42dc63843bfdULL, 0x91ae7eef41fc52d0ULL, 0x9bb056cd7dac1ce6ULL,
+    0xe23baf4d76437894ULL, 0xbbd0d66dbdb16106ULL, 0x41c319589b32f1daULL, 0x6eb2a5cb7957e517ULL,
+    0xa5f2ae0bf941b35cULL, 0xcb400bc08016564bULL, 0x6bbdb1da677fc20cULL, 0x95a26efb59dc7eccULL,
+    0xa1febe1fe1619f40ULL, 0xf308eb1810cbc3e3ULL, 0xb1cefe4f81e12f30ULL, 0x0206080a0c10160eULL,
+    0xcc4917db922e675eULL, 0xc45137f3a26e3f66ULL, 0x1d2774694ee8cf53ULL, 0x143c504478a09c6cULL,
+    0xc3582be8b0560e73ULL, 0x63a591f2573f9a34ULL, 0xda734f95e69eed3cULL, 0x5de76934d3d2358eULL,
+    0x5fe1613edfc22380ULL, 0xdc79578bf2aed72eULL, 0x7d87e99413cf486eULL, 0xcd4a13de94266c59ULL,
+    0x7f81e19e1fdf5e60ULL, 0x5aee752fc1ea049bULL, 0x6cb4adc17547f319ULL, 0x5ce46d31d5da3e89ULL,
+    0xf704fb0c08ebefffULL, 0x266a98bed42d47f2ULL, 0xff1cdb2438abb7c7ULL, 0xed2a937e543b11b9ULL,
+    0xe825876f4a1336a2ULL, 0x9dba4ed3699c26f4ULL, 0x6fb1a1ce7f5fee10ULL, 0x8e8f028c03048b8dULL,
+    0x192b647d56c8e34fULL, 0xa0fdba1ae7699447ULL, 0xf00de7171ad3deeaULL, 0x89861e97113cba98ULL,
+    0x0f113c332278692dULL, 0x07091c1b12383115ULL, 0xafec8629c511fd6aULL, 0xfb10cb30208b9bdbULL,
+    0x0818202830405838ULL, 0x153f54417ea8976bULL, 0x0d1734392e687f23ULL, 0x040c101418202c1cULL,
+    0x0103040506080b07ULL, 0x64ac8de94507ab21ULL, 0xdf7c5b84f8b6ca27ULL, 0x769ac5b329970d5fULL,
+    0x798bf9800bef6472ULL, 0xdd7a538ef4a6dc29ULL, 0x3d47f4c98ef5b2b3ULL, 0x163a584e74b08a62ULL,
+    0x3f41fcc382e5a4bdULL, 0x3759dcebb2a5fc85ULL, 0x6db7a9c4734ff81eULL, 0x3848e0d890dd95a8ULL,
+    0xb9d6de67b1a17708ULL, 0x7395d1a237bf2a44ULL, 0xe926836a4c1b3da5ULL, 0x355fd4e1beb5ea8bULL,
+    0x55ff491ce3926db6ULL, 0x7193d9a83baf3c4aULL, 0x7b8df18a07ff727cULL, 0x8c890a860f149d83ULL,
+    0x7296d5a731b72143ULL, 0x88851a921734b19fULL, 0xf607ff090ee3e4f8ULL, 0x2a7ea882fc4d33d6ULL,
+    0x3e42f8c684edafbaULL, 0x5ee2653bd9ca2887ULL, 0x27699cbbd2254cf5ULL, 0x46ca0543890ac0cfULL,
+    0x0c14303c28607424ULL, 0x65af89ec430fa026ULL, 0x68b8bdd56d67df05ULL, 0x61a399f85b2f8c3aULL,
+    0x03050c0f0a181d09ULL, 0xc15e23e2bc46187dULL, 0x57f94116ef827bb8ULL, 0xd6677fa9cefe9918ULL,
+    0xd976439aec86f035ULL, 0x58e87d25cdfa1295ULL, 0xd875479fea8efb32ULL, 0x66aa85e34917bd2fULL,
+    0xd7647bacc8f6921fULL, 0x3a4ee8d29ccd83a6ULL, 0xc84507cf8a0e4b42ULL, 0x3c44f0cc88fdb9b4ULL,
+    0xfa13cf35268390dcULL, 0x96a762f453c463c5ULL, 0xa7f4a601f551a552ULL, 0x98b55ac277b401efULL,
+    0xec29977b52331abeULL, 0xb8d5da62b7a97c0fULL, 0xc7543bfca876226fULL, 0xaeef822cc319f66dULL,
+    0x69bbb9d06b6fd402ULL, 0x4bdd317aa762bfecULL, 0xabe0963ddd31d176ULL, 0xa9e69e37d121c778ULL,
+    0x67a981e64f1fb628ULL, 0x0a1e28223c504e36ULL, 0x47c901468f02cbc8ULL, 0xf20bef1d16c3c8e4ULL,
+    0xb5c2ee5b99c1032cULL, 0x226688aacc0d6beeULL, 0xe532b356647b4981ULL, 0xee2f9f715e230cb0ULL,
+    0xbedfc27ca399461dULL, 0x2b7dac87fa4538d1ULL, 0x819e3ebf217ce2a0ULL, 0x1236485a6c90a67eULL,
+    0x839836b52d6cf4aeULL, 0x1b2d6c775ad8f541ULL, 0x0e1238362470622aULL, 0x23658cafca0560e9ULL,
+    0xf502f30604fbf9f1ULL, 0x45cf094c8312ddc6ULL, 0x216384a5c61576e7ULL, 0xce4f1fd19e3e7150ULL,
+    0x49db3970ab72a9e2ULL, 0x2c74b09ce87d09c4ULL, 0xf916c33a2c9b8dd5ULL, 0xe637bf596e635488ULL,
+    0xb6c7e25493d91e25ULL, 0x2878a088f05d25d8ULL, 0x17395c4b72b88165ULL, 0x829b32b02b64ffa9ULL,
+    0x1a2e68725cd0fe46ULL, 0x8b80169d1d2cac96ULL, 0xfe1fdf213ea3bcc0ULL, 0x8a8312981b24a791ULL,
+    0x091b242d3648533fULL, 0xc94603ca8c064045ULL, 0x879426a1354cd8b2ULL, 0x4ed2256bb94a98f7ULL,
+    0xe13ea3427c5b659dULL, 0x2e72b896e46d1fcaULL, 0xe431b75362734286ULL, 0xe03da7477a536e9aULL,
+    0xeb208b60400b2babULL, 0x90ad7aea47f459d7ULL, 0xa4f1aa0eff49b85bULL, 0x1e22786644f0d25aULL,
+    0x85922eab395ccebcULL, 0x60a09dfd5d27873dULL, 0x0000000000000000ULL, 0x256f94b1de355afbULL,
+    0xf401f70302f3f2f6ULL, 0xf10ee3121cdbd5edULL, 0x94a16afe5fd475cbULL, 0x0b1d2c273a584531ULL,
+    0xe734bb5c686b5f8fULL, 0x759fc9bc238f1056ULL, 0xef2c9b74582b07b7ULL, 0x345cd0e4b8bde18cULL,
+    0x3153c4f5a695c697ULL, 0xd46177a3c2ee8f16ULL, 0xd06d67b7dacea30aULL, 0x869722a43344d3b5ULL,
+    0x7e82e59b19d75567ULL, 0xadea8e23c901eb64ULL, 0xfd1ad32e34bba1c9ULL, 0x297ba48df6552edfULL,
+    0x3050c0f0a09dcd90ULL, 0x3b4decd79ac588a1ULL, 0x9fbc46d9658c30faULL, 0xf815c73f2a9386d2ULL,
+    0xc6573ff9ae7e2968ULL, 0x13354c5f6a98ad79ULL, 0x060a181e14303a12ULL, 0x050f14111e28271bULL,
+    0xc55233f6a4663461ULL, 0x113344556688bb77ULL, 0x7799c1b62f9f0658ULL, 0x7c84ed9115c74369ULL,
+    0x7a8ef58f01f7797bULL, 0x7888fd850de76f75ULL, 0x365ad8eeb4adf782ULL, 0x1c24706c48e0c454ULL,
+    0x394be4dd96d59eafULL, 0x59eb7920cbf21992ULL, 0x1828607850c0e848ULL, 0x56fa4513e98a70bfULL,
+    0xb3c8f6458df1393eULL, 0xb0cdfa4a87e92437ULL, 0x246c90b4d83d51fcULL, 0x206080a0c01d7de0ULL,
+    0xb2cbf2408bf93239ULL, 0x92ab72e04be44fd9ULL, 0xa3f8b615ed71894eULL, 0xc05d27e7ba4e137aULL,
+    0x44cc0d49851ad6c1ULL, 0x62a695f751379133ULL, 0x103040506080b070ULL, 0xb4c1ea5e9fc9082bULL,
+    0x84912aae3f54c5bbULL, 0x43c511529722e7d4ULL, 0x93a876e54dec44deULL, 0xc25b2fedb65e0574ULL,
+    0x4ade357fa16ab4ebULL, 0xbddace73a9815b14ULL, 0x8f8c0689050c808aULL, 0x2d77b499ee7502c3ULL,
+    0xbcd9ca76af895013ULL, 0x9cb94ad66f942df3ULL, 0x6abeb5df6177c90bULL, 0x40c01d5d9d3afaddULL,
+    0xcf4c1bd498367a57ULL, 0xa2fbb210eb798249ULL, 0x809d3aba2774e9a7ULL, 0x4fd1216ebf4293f0ULL,
+    0x1f217c6342f8d95dULL, 0xca430fc5861e5d4cULL, 0xaae39238db39da71ULL, 0x42c61557912aecd3ULL,
+};
+
+/*
+ * byte j moved to position j^1 / j^2 / j^4:
+ */
+static inline u64 compact_swap8(const u64 x) {
+	return ((x & 0x00ff00ff00ff00ffULL) << 8) | ((x >> 8) & 0x00ff00ff00ff00ffULL);
+}
+
+static inline u64 compact_swap16(const u64 x) {
+	return ((x & 0x0000ffff0000ffffULL) << 16) | ((x >> 16) & 0x0000ffff0000ffffULL);
+}
+
+static inline u64 compact_swap32(const u64 x) {
+	return (x << 32) | (x >> 32);
+}
+
+/**
+ * Either encrypt or decrypt a data block, according to the key schedule,
+ * using the single table C0.
+ *
+ * @param	plaintext	the data block to be encrypted/decrypted.
+ * @param	ciphertext	the resulting data block.
+ * @param	roundKey	the key schedule to be used.
+ */
+static void crypt_compact(const u8 plaintext[/*8*/], u8 ciphertext[/*8*/],
+						  const u32 roundKey[R + 1][2]) {
+	int r;
+	u64 state, a0, a1, a2, a3, a4, a5, a6, a7;
+
+	/*
+	 * map plaintext block to cipher state (mu)
+	 * and add initial round key (sigma[K^0]):
+	 */
+	state =
+		((u64)plaintext[0] << 56) ^
+		((u64)plaintext[1] << 48) ^
+		((u64)plaintext[2] << 40) ^
+		((u64)plaintext[3] << 32) ^
+		((u64)plaintext[4] << 24) ^
+		((u64)plaintext[5] << 16) ^
+		((u64)plaintext[6] <<  8) ^
+		((u64)plaintext[7]      ) ^
+		(((u64)roundKey[0][0] << 32) ^ roundKey[0][1]);
+
+	/*
+	 * R - 1 full rounds:
+	 */
+	for (r = 1; r < R; r++) {
+		a0 = C0[(int)(state >> 56)       ];
+		a1 = C0[(int)(state >> 48) & 0xff];
+		a2 = C0[(int)(state >> 40) & 0xff];
+		a3 = C0[(int)(state >> 32) & 0xff];
+		a4 = C0[(int)(state >> 24) & 0xff];
+		a5 = C0[(int)(state >> 16) & 0xff];
+		a6 = C0[(int)(state >>  8) & 0xff];
+		a7 = C0[(int)(state      ) & 0xff];
+		state =
+			a0 ^ compact_swap8(a1) ^ compact_swap16(a2 ^ compact_swap8(a3)) ^
+			compact_swap32(a4 ^ compact_swap8(a5) ^ compact_swap16(a6 ^ compact_swap8(a7))) ^
+			(((u64)roundKey[r][0] << 32) ^ roundKey[r][1]);
+	}
+
+	/*
+	 * last round (S-box only - byte 0 of C0[x] is S[x]):
+	 */
+	state =
+		( C0[(int)(state >> 56)       ]        & 0xff00000000000000ULL) ^
+		((C0[(int)(state >> 48) & 0xff] >>  8) & 0x00ff000000000000ULL) ^
+		((C0[(int)(state >> 40) & 0xff] >> 16) & 0x0000ff0000000000ULL) ^
+		((C0[(int)(state >> 32) & 0xff] >> 24) & 0x000000ff00000000ULL) ^
+		((C0[(int)(state >> 24) & 0xff] >> 32) & 0x00000000ff000000ULL) ^
+		((C0[(int)(state >> 16) & 0xff] >> 40) & 0x0000000000ff0000ULL) ^
+		((C0[(int)(state >>  8) & 0xff] >> 48) & 0x000000000000ff00ULL) ^
+		((C0[(int)(state      ) & 0xff] >> 56)                        ) ^
+		(((u64)roundKey[R][0] << 32) ^ roundKey[R][1]);
+
+	/*
+	 * map cipher state to ciphertext block (mu^{-1}):
+	 */
+	ciphertext[0] = (u8)(state >> 56);
+	ciphertext[1] = (u8)(state >> 48);
+	ciphertext[2] = (u8)(state >> 40);
+	ciphertext[3] = (u8)(state >> 32);
+	ciphertext[4] = (u8)(state >> 24);
+	ciphertext[5] = (u8)(state >> 16);
+	ciphertext[6] = (u8)(state >>  8);
+	ciphertext[7] = (u8)(state      );
+}
+
+/**
+ * Encrypt a data block with the single-table implementation.
+ *
+ * @param	structpointer	the expanded key (from NESSIEkeysetup).
+ * @param	plaintext		the data block to be encrypted.
+ * @param	ciphertext		the encrypted data block.
+ */
+void NESSIEencrypt_compact(const struct NESSIEstruct * const structpointer,
+						   const unsigned char * const plaintext,
+						         unsigned char * const ciphertext) {
+	crypt_compact(plaintext, ciphertext, structpointer->roundKeyEnc);
+}
+
+/**
+ * Decrypt a data block with the single-table implementation.
+ *
+ * @param	structpointer	the expanded key (from NESSIEkeysetup).
+ * @param	ciphertext		the data block to be decrypted.
+ * @param	plaintext		the decrypted data block.
+ */
+void NESSIEdecrypt_compact(const struct NESSIEstruct * const structpointer,
+						   const unsigned char * const ciphertext,
+						         unsigned char * const plaintext) {
+	crypt_compact(ciphertext, plaintext, structpointer->roundKeyDec);
+}
+
+#endif   /* KHAZAD_COMPACT_H */
@@ -0,0 +1,165 @@
+#ifndef KHAZAD_CTR_H
+#define KHAZAD_CTR_H
+/********************************************************************************************************
+*********************************************************************************************************
+Zynq-7000 based Implementation of the KHAZAD Block Cipher
+Yossef Shitzer & Efraim Wasserman
+Jerusalem College of Technology - Lev Academic Center (JCT)
+Department of electrical and electronic engineering
+2018
+*********************************************************************************************************
+*********************************************************************************************************
+This file implements a software CTR (counter) mode engine, for buffers of any length in bytes.
+The counter block of data block i is IV + i (a 64-bit big-endian integer, modulo 2^64),
+and the key stream is E(IV), E(IV + 1), ...
+The engine keeps the byte position in the key stream, so a message may be processed in several calls
+of any length, and khazad_ctr_seek gives random access to any byte of the stream.
+The whole blocks are processed in chunks of BULK_CHUNK_BLOCKS by the multi-block functions
+("khazad-bulk.h", "khazad-tweak64.h"): the counter blocks of a chunk are encrypted together, and then
+XORed with the data in one pass, so there is no per-block call overhead.
+Constant-time option (khazad_ctr_set_bitsliced): the key stream, of the whole and of the partial blocks, is
+generated by the bitsliced implementation ("khazad-bitslice.h", BS_LANES counter blocks per pass), with no
+table lookups, so the time does not depend on the key (no cache-timing variance). The key stream is the same.
+Encryption and decryption are the same operation, and the output may be the same buffer as the input.
+Usage:
+	struct khazad_ctr ctr;
+	khazad_ctr_init(&ctr, &subkeys, IV);
+	khazad_ctr_set_bitsliced(&ctr, 1);			// optional: constant time
+	khazad_ctr_crypt(&ctr, data, data, length);	// in place
+	khazad_ctr_seek(&ctr, offset);				// e.g. to decrypt a part of the message
+*********************************************************************************************************
+*********************************************************************************************************/
+
+#include <stddef.h>
+#include <string.h>
+#include "nessie_modified.h"
+#include "khazad-tweak64.h"
+#include "khazad-bulk.h"
+#include "khazad-bitslice.h"
+
+struct khazad_ctr {
+	const struct NESSIEstruct *structpointer;
+	u64 iv;  // the counter block of data block 0
+	u64 position;  // the byte position in the key stream
+	u8 stream[BLOCKSIZEB];  // the key stream block of a partial data block
+	u64 stream_block;  // the data block index of stream
+	u8 stream_valid;
+	u8 bitsliced;  // the key stream is generated by the bitsliced implementation (constant time)
+};
+
+
+/**
+ * Initialize a CTR engine at the start of the key stream.
+ *
+ * @param	ctr				the engine state.
+ * @param	structpointer	the expanded key (from NESSIEkeysetup). Must remain valid while ctr is used.
+ * @param	IV				the initial counter block (8 bytes).
+ */
+void khazad_ctr_init(struct khazad_ctr *ctr, const struct NESSIEstruct * const structpointer, const u8 * const IV) {
+	ctr->structpointer = structpointer;
+	ctr->iv = U8TO64_BIG(IV);
+	ctr->position = 0;
+	ctr->stream_valid = 0;
+	ctr->bitsliced = 0;
+}
+
+/**
+ * Select the key stream implementation: the interleaved table-based functions (the default, faster),
+ * or the bitsliced implementation (constant time). Both generate the same key stream.
+ *
+ * @param	ctr			the engine state.
+ * @param	bitsliced	1 - bitsliced, 0 - table-based.
+ */
+void khazad_ctr_set_bitsliced(struct khazad_ctr *ctr, const u8 bitsliced) {
+	ctr->bitsliced = bitsliced;
+}
+
+/**
+ * Move to a byte position in the key stream (random access).
+ *
+ * @param	ctr			the engine state.
+ * @param	position	the byte position (0 - the first byte of the message).
+ */
+void khazad_ctr_seek(struct khazad_ctr *ctr, const u64 position) {
+	ctr->position = position;
+}
+
+/**
+ * Compute the key stream block of a data block, for partial blocks.
+ */
+static void khazad_ctr_stream(struct khazad_ctr *ctr, const u64 block) {
+	if (ctr->stream_valid && ctr->stream_block == block)
+		return;
+	if (ctr->bitsliced)
+		NESSIEkeystream_bitsliced(ctr->structpointer, ctr->iv + block, ctr->stream, 1);
+	else {
+		U64TO8_BIG(ctr->stream, ctr->iv + block);
+		NESSIEencrypt64(ctr->structpointer, ctr->stream, ctr->stream);
+	}
+	ctr->stream_block = block;
+	ctr->stream_valid = 1;
+}
+
+/**
+ * Encrypt or decrypt data from the current position in the key stream, and advance the position.
+ *
+ * @param	ctr		the engine state.
+ * @param	input	the data (plaintext or ciphertext).
+ * @param	output	the result (may be the same buffer as input).
+ * @param	length	number of bytes.
+ */
+void khazad_ctr_crypt(struct khazad_ctr *ctr, const u8 *input, u8 *output, size_t length) {
+	u32 offset = (u32)(ctr->position % BLOCKSIZEB), n;
+	size_t blocks;
+	u8 counter[BLOCKSIZEB];
+
+	/*
+	 * the rest of a partial data block:
+	 */
+	if (offset != 0 && length != 0) {
+		khazad_ctr_stream(ctr, ctr->position / BLOCKSIZEB);
+		for (; offset < BLOCKSIZEB && length != 0; offset++, length--, ctr->position++)
+			*output++ = *input++ ^ ctr->stream[offset];
+	}
+
+	/*
+	 * whole data blocks, in chunks:
+	 */
+	for (blocks = length / BLOCKSIZEB; blocks != 0; blocks -= n) {
+		n = (blocks < BULK_CHUNK_BLOCKS) ? (u32)blocks : BULK_CHUNK_BLOCKS;
+		if (ctr->bitsliced) {
+			U64TO8_BIG(counter, ctr->iv + ctr->position / BLOCKSIZEB);
+			NESSIEcrypt_CTR_bitsliced(ctr->structpointer, counter, input, output, n);
+		}
+		else
+			bulk_ctr_chunk(ctr->structpointer, ctr->iv + ctr->position / BLOCKSIZEB, input, output, n);
+		input += BLOCKSIZEB*n;
+		output += BLOCKSIZEB*n;
+		length -= BLOCKSIZEB*n;
+		ctr->position += BLOCKSIZEB*n;
+	}
+
+	/*
+	 * the start of a partial data block:
+	 */
+	if (length != 0) {
+		khazad_ctr_stream(ctr, ctr->position / BLOCKSIZEB);
+		for (offset = 0; offset < length; offset++)
+			output[offset] = input[offset] ^ ctr->stream[offset];
+		ctr->position += length;
+	}
+}
+
+/**
+ * Write the key stream itself from the current position (e.g. for random data), and advance the position.
+ *
+ * @param	ctr		the engine state.
+ * @param	output	the key stream bytes.
+ * @param	length	number of bytes.
+ */
+void khazad_ctr_keystream(struct khazad_ctr *ctr, u8 *output, const size_t length) {
+	memset(output, 0, length);
+	khazad_ctr_crypt(ctr, output, output, length);
+}
+
+#endif   /* KHAZAD_CTR_H */
@@ -0,0 +1,150 @@
+#ifndef KHAZAD_HAL_AUTH_H
+#define KHAZAD_HAL_AUTH_H
+/********************************************************************************************************
+*********************************************************************************************************
+Zynq-7000 based Implementation of the KHAZAD Block Cipher
+Yossef Shitzer & Efraim Wasserman
+Jerusalem College of Technology - Lev Academic Center (JCT)
+Department of electrical and electronic engineering
+2018
+*********************************************************************************************************
+*********************************************************************************************************
+This file implements the authentication modes of the PL driver, on the hardware access layer ("khazad-hal.h"),
+with the same formats and results as the software engines:
+	khazad_hal_ccm - single-pass CCM ("khazad-ccm.h"): the PL design runs in ECB mode, and for every block
+			encrypts the CBC-MAC state and the next counter block, while the PS does the CBC chaining XOR and
+			the key stream XOR, so each message block is read once.
+	khazad_hal_pmac - PMAC ("khazad-pmac.h"): the PL design runs in ECB mode, and the blocks are sent back to
+			back: the input of every block depends only on the message and the offset (computed by the PS),
+			not on the previous result, as in CBC-MAC.
+The key is sent only with the first block, and all the other blocks use the only_data option, so the PL
+design holds the key afterwards (see the key reload elision of khazad-hal.h).
+They are the bodies of Zynq_ccm and Zynq_pmac (KHAZAD_Zynq.h), and run on any backend, so they are
+cross-checked with the software engines on the model (see linux/khazad_hal_test.c).
+Usage:
+	khazad_hal_pmac(&hal, key, message, length, tag);
+	if (khazad_hal_ccm(&hal, key, nonce, text, length, enc_dec, result, tag) != 0)
+		...	// too long, or (decryption) not authentic: the result is erased
+*********************************************************************************************************
+*********************************************************************************************************/
+
+#include <string.h>
+#include <stdbool.h>
+#include "nessie_modified.h"
+#include "khazad-tweak64.h"
+#include "khazad-ccm.h"
+#include "khazad-pmac.h"
+#include "khazad-hal.h"
+
+
+/**
+ * Encrypt or decrypt a message in the PL design, and compute or verify its CCM tag, in one pass.
+ *
+ * @param	key		the key (KEYSIZEB bytes).
+ * @param	nonce	CCM_NONCEB bytes, unique for every message of the key.
+ * @param	text	the input (plaintext or ciphertext).
+ * @param	length	number of bytes, up to CCM_MAX_LENGTH (the 31-bit length field of B0).
+ * @param	enc_dec	1: encryption, 0: decryption.
+ * @param	result	the output, of length bytes (may be the same buffer as text).
+ * @param	tag		encryption - the computed tag, decryption - the received tag (CCM_TAGB bytes).
+ * @return	0, or -1 if a decrypted message is not authentic (the result is then erased),
+ * 			or if length is above CCM_MAX_LENGTH (nothing is processed).
+ */
+int khazad_hal_ccm(struct khazad_hal *hal, const u8 * const key, const u8 * const nonce, const u8 * const text,
+				   const u32 length, const bool enc_dec, u8 * const result, u8 * const tag) {
+	u8 mac[BLOCKSIZEB], stream[BLOCKSIZEB], block[BLOCKSIZEB], c, p, diff = 0;
+	u32 key1, key2, key3, key4, n = (length + BLOCKSIZEB - 1)/BLOCKSIZEB, k, m, i, j;
+	u64 base;
+
+	if (length > CCM_MAX_LENGTH)  // a longer length would clear the MAC flag of B0
+		return -1;
+
+	key1 = hal_load32(key);
+	key2 = hal_load32(key + 4);
+	key3 = hal_load32(key + 8);
+	key4 = hal_load32(key + 12);
+	base = ((u64)nonce[0] << 56) ^ ((u64)nonce[1] << 48) ^ ((u64)nonce[2] << 40) ^ ((u64)nonce[3] << 32);
+
+	// B0 (with the key), and the first counter block (A_1, or A_0 for an empty message):
+	U64TO8_BIG(mac, base ^ CCM_MAC_FLAG ^ length);
+	khazad_hal_crypt(hal, mac, key1, key2, key3, key4, 0, 0, 0, 1, 0, 0, 0, mac);  // only_data=0, enc_dec=1, op_mode=0
+	U64TO8_BIG(block, (n == 0) ? base : base + 1);
+	khazad_hal_crypt(hal, block, key1, key2, key3, key4, 0, 0, 1, 1, 0, 0, 0, stream);
+
+	for (k = 1; k <= n; k++) {
+		i = (k - 1)*BLOCKSIZEB;
+		m = (length - i < BLOCKSIZEB) ? length - i : BLOCKSIZEB;
+		for (j = 0; j < m; j++) {  // the bytes after a partial last block are zero padding for the CBC-MAC
+			c = text[i + j] ^ stream[j];
+			p = enc_dec ? text[i + j] : c;
+			result[i + j] = c;
+			mac[j] ^= p;
+		}
+		khazad_hal_crypt(hal, mac, key1, key2, key3, key4, 0, 0, 1, 1, 0, 0, 0, mac);
+		U64TO8_BIG(block, (k < n) ? base + k + 1 : base);  // A_{k+1}, or A_0 after the last block
+		khazad_hal_crypt(hal, block, key1, key2, key3, key4, 0, 0, 1, 1, 0, 0, 0, stream);
+	}
+
+	// tag = CBC-MAC ^ E(A_0):
+	for (j = 0; j < CCM_TAGB; j++) {
+		if (enc_dec)
+			tag[j] = mac[j] ^ stream[j];
+		else
+			diff |= tag[j] ^ mac[j] ^ stream[j];  // constant time comparison
+	}
+	if (diff) {
+		memset(result, 0, length);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Compute the PMAC of a message in the PL design.
+ *
+ * @param	key		the key (KEYSIZEB bytes).
+ * @param	message	the message.
+ * @param	length	number of bytes (any length, including 0).
+ * @param	tag		the MAC (BLOCKSIZEB bytes).
+ */
+void khazad_hal_pmac(struct khazad_hal *hal, const u8 * const key, const u8 * const message, const u32 length,
+					 u8 * const tag) {
+	u8 block[BLOCKSIZEB] = {0}, last[BLOCKSIZEB] = {0};
+	u32 key1, key2, key3, key4, i, j;
+	u32 blocks = (length == 0) ? 0 : (length - 1)/BLOCKSIZEB;  // all the blocks before the last one
+	u32 residue = length - BLOCKSIZEB*blocks;
+	u64 L[PMAC_LEVELS], offset = 0, sigma = 0;
+
+	key1 = hal_load32(key);
+	key2 = hal_load32(key + 4);
+	key3 = hal_load32(key + 8);
+	key4 = hal_load32(key + 12);
+
+	// L = E(0), with the key:
+	khazad_hal_crypt(hal, block, key1, key2, key3, key4, 0, 0, 0, 1, 0, 0, 0, block);  // only_data=0, enc_dec=1, op_mode=0
+	L[0] = U8TO64_BIG(block);
+	for (j = 1; j < PMAC_LEVELS; j++)
+		L[j] = pmac_double(L[j - 1]);
+
+	// all the blocks before the last one:
+	for (i = 1; i <= blocks; i++) {
+		offset ^= L[pmac_ntz(i)];
+		U64TO8_BIG(block, U8TO64_BIG(message + (i - 1)*BLOCKSIZEB) ^ offset);
+		khazad_hal_crypt(hal, block, key1, key2, key3, key4, 0, 0, 1, 1, 0, 0, 0, block);
+		sigma ^= U8TO64_BIG(block);
+	}
+
+	// the last block, and the tag:
+	if (residue)
+		memcpy(last, message + blocks*BLOCKSIZEB, residue);
+	if (residue == BLOCKSIZEB)
+		sigma ^= U8TO64_BIG(last) ^ pmac_half(L[0]);
+	else {
+		last[residue] = 0x80;  // 10...0 padding
+		sigma ^= U8TO64_BIG(last);
+	}
+	U64TO8_BIG(tag, sigma);
+	khazad_hal_crypt(hal, tag, key1, key2, key3, key4, 0, 0, 1, 1, 0, 0, 0, tag);
+}
+
+#endif   /* KHAZAD_HAL_AUTH_H */
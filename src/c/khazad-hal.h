@@ -0,0 +1,768 @@
+#ifndef KHAZAD_HAL_H
+#define KHAZAD_HAL_H
+/********************************************************************************************************
+*********************************************************************************************************
+Zynq-7000 based Implementation of the KHAZAD Block Cipher
+Yossef Shitzer & Efraim Wasserman
+Jerusalem College of Technology - Lev Academic Center (JCT)
+Department of electrical and electronic engineering
+2018
+*********************************************************************************************************
+*********************************************************************************************************
+This file implements the hardware access layer of the PL driver: every bus access of the driver
+(AXI_GPIO register writes and reads, GPIO_4 direction changes, and the ready flag polling on EMIO pin 54)
+goes through a backend, and is counted:
+	Xilinx backend - the real registers (Xil_Out32 / Xil_In32, the XGpio and XGpioPs drivers).
+			Standalone BSP only (not with KHAZAD_LINUX).
+	UIO backend - the real registers under Linux, mapped into a userspace process ("khazad-uio.h").
+	model backend - a software model of the PL design registers and semantics: controller.v (the start/ready
+			semaphore, RST) and enveloped_KHAZAD.v (KHAZAD with the key period flag only_data, op_mode_enc,
+			op_mode_dec and CBC_dec_memory for the CBC mode). The operation ends immediately.
+	cycle model backend - the same model, with a PL clock: every AXI access and ready flag read takes a fixed
+			number of PL clock cycles, and an operation ends HAL_CYCLES_KEY or HAL_CYCLES_DATA cycles after
+			its start, so the number of polls and the PL cycles per block are as on the board.
+			The AXI and polling costs are estimates, and may be calibrated with the board.
+Data registers: in the version 2.0 PL design (the bitstream in hw/ and sd_image/), d_in and d_out share the
+bidirectional AXI_GPIO_4 (ADDR4), and every block changes its direction twice. Define HAL_SPLIT_DATA for a
+block design with separate data registers (see wiring.v): the data block is written to the output-only
+AXI_GPIO_4 (d_in) and read from an input-only AXI_GPIO_5 (d_out, ADDR5), so a block costs two data writes,
+one ctrl write and two reads. That block design and its bitstream are not in this repository yet, so
+HAL_SPLIT_DATA must not be defined for the shipped bitstream (ADDR5 is not mapped there).
+Completion wait (hal->wait_mode):
+	HAL_WAIT_POLL - the ready flag is polled until the operation ends (the core is busy all the time).
+	HAL_WAIT_HYBRID - the ready flag is polled hal->spin_polls times, then the core sleeps (WFI) until the
+			done_IRQ interrupt of controller.v (IRQ_F2P[0]), and polls the ready flag again.
+			Short operations end during the spin, and long ones don't keep the core busy.
+			Xilinx backend: the version 2.0 PL design (the bitstream in hw/ and sd_image/) has no done_IRQ, so
+			the sleep is compiled only with HAL_DONE_IRQ (a block design with controller.v version 3.0 and
+			done_IRQ on IRQ_F2P[0]), and only after khazad_hal_xilinx_set_irq; otherwise HAL_WAIT_HYBRID polls.
+			The interrupt is enabled in the GIC only during a sleep (no exception per block when polling), and
+			every sleep is bounded by the SCU private timer (HAL_SLEEP_TIMEOUT_US), so a missing interrupt
+			costs a timeout, not a hang.
+Multi-block calls (khazad_hal_crypt_blocks, the body of Zynq_crypt_blocks): a session context holds the key
+and the IV words; the key and the IV are sent with the first block only, the other blocks use only_data,
+and since KHAZAD latches data_in at the start of an only_data operation, the next data block is sent while
+the current one runs (not in the bidirectional design, where GPIO_4 is an input until the result is read).
+The data words are loaded and stored as whole big-endian words (one access and a byte reverse).
+Key reload elision: the HAL remembers the key and the IV that the PL design holds (hal->loaded), for all the
+sessions and call sites. A key operation (only_data = 0) with the loaded key runs as only_data, without the key
+writes and the key schedule, and the IV writes of the loaded IV are skipped. khazad_hal_reset forgets them,
+and khazad_hal_set_elision(hal, 0) sends them every time (to measure the key schedule).
+The driver itself (khazad_hal_crypt, the body of Zynq_crypt) is the same for all the backends,
+so it can be run and regression-tested on any Linux machine (see linux/khazad_hal_test.c).
+Usage:
+	struct khazad_hal hal;
+	struct khazad_hal_model model;
+	khazad_hal_model_init(&hal, &model, 1);	// 1: cycle model
+	khazad_hal_crypt(&hal, text, key1, key2, key3, key4, IV1, IV2, only_data, enc_dec, op_mode, first_block, new_IV, result);
+	hal.stats.writes / hal.stats.blocks ...
+	struct khazad_hal_ctx ctx;
+	khazad_hal_ctx_init(&ctx, key, IV);		// IV = NULL for ECB
+	khazad_hal_crypt_blocks(&hal, &ctx, in, out, nblocks, op_mode, enc_dec);
+*********************************************************************************************************
+*********************************************************************************************************/
+
+#include <string.h>
+#include <stdbool.h>
+#include "nessie_modified.h"
+#include "khazad-tweak64.h"
+#ifndef KHAZAD_LINUX
+#include "xgpio.h"
+#include "xgpiops.h"
+#include "xil_exception.h"
+#include "xpseudo_asm.h"
+#include "xtime_l.h"
+#ifdef HAL_DONE_IRQ
+#include "xscugic.h"
+#include "xscutimer.h"
+#endif
+#endif
+
+// AXI_GPIO modules registers addresses:
+#define ADDR0 ((unsigned int)0x41200000)
+#define ADDR1 ((unsigned int)0x41210000)
+#define ADDR2 ((unsigned int)0x41220000)
+#define ADDR3 ((unsigned int)0x41230000)
+#define ADDR4 ((unsigned int)0x41240000)
+#define ADDR5 ((unsigned int)0x41250000)
+#define ADDR_offset ((unsigned int)0x00000008)
+
+// the EMIO pin of the ready flag (ctrl_to_PS of controller.v):
+#define HAL_READY_PIN  54
+
+// GPIO_4 directions (without HAL_SPLIT_DATA):
+#define HAL_DIR_OUTPUT  0x00000000
+#define HAL_DIR_INPUT   0xFFFFFFFF
+
+// PL clock cycles from the start command to the ready flag (KHAZAD.v FSM, plus the start and finish registers):
+#define HAL_CYCLES_KEY   26  // key schedule (16) and 8 rounds
+#define HAL_CYCLES_DATA  10  // only_data: 8 rounds
+
+// completion wait modes:
+#define HAL_WAIT_POLL    0
+#define HAL_WAIT_HYBRID  1
+
+// default number of ready flag polls before sleeping, in HAL_WAIT_HYBRID mode:
+#ifndef HAL_SPIN_POLLS
+#define HAL_SPIN_POLLS   4
+#endif
+
+// default cycle model costs, in PL clock cycles:
+#ifndef HAL_AXI_CYCLES
+#define HAL_AXI_CYCLES   16  // one AXI_GPIO register access through M_AXI_GP0
+#endif
+#ifndef HAL_POLL_CYCLES
+#define HAL_POLL_CYCLES  4   // one EMIO pin read
+#endif
+#ifndef HAL_IRQ_CYCLES
+#define HAL_IRQ_CYCLES   40  // from the interrupt to the core running again after WFI (GIC, exception entry and return)
+#endif
+
+// the longest WFI sleep of the Xilinx backend, in microseconds (then the ready flag is polled again):
+#ifndef HAL_SLEEP_TIMEOUT_US
+#define HAL_SLEEP_TIMEOUT_US  100
+#endif
+
+// bus transaction counters (all the counters are totals; divide by blocks for the cost per block):
+struct khazad_hal_stats {
+	u32 blocks;  // crypt operations
+	u32 writes;  // AXI register writes, including the ctrl register
+	u32 reads;  // AXI register reads
+	u32 direction_changes;  // GPIO_4 direction register writes
+	u32 polls;  // ready flag reads
+	u32 sleeps;  // WFI sleeps (HAL_WAIT_HYBRID)
+	u64 sleep_time;  // time asleep: global timer ticks (Xilinx), PL clock cycles (cycle model), nanoseconds (UIO)
+	u64 cycles;  // PL clock cycles (cycle model backend only)
+	u32 keys;  // key operations (key writes and key schedule)
+	u32 keys_elided;  // key operations with the loaded key, run as only_data
+};
+
+struct khazad_hal_ops {
+	void (*out32)(void *instance, const u32 addr, const u32 value);
+	void (*out16)(void *instance, const u32 addr, const u16 value);
+	u32  (*in32)(void *instance, const u32 addr);
+	void (*set_direction)(void *instance, const u32 direction);
+	u32  (*read_ready)(void *instance);
+	u64  (*sleep)(void *instance, const u16 ctrl);  // sleep until an interrupt, unless the ready flag = LSB of ctrl
+};
+
+// a multi-block session: the key and the IV (the chaining value of the next block, for CBC) as register words:
+struct khazad_hal_ctx {
+	u32 key[4];  // key1, key2, key3, key4
+	u32 IV[2];  // IV1, IV2
+};
+
+struct khazad_hal {
+	const struct khazad_hal_ops *ops;
+	void *instance;  // the backend state
+	u16 ctrl;  // the last value sent to the ctrl register (ctrl_from_PS[5:0] of controller.v, see main.c)
+	u8 wait_mode;  // HAL_WAIT_POLL or HAL_WAIT_HYBRID
+	u32 spin_polls;  // polls before sleeping (HAL_WAIT_HYBRID)
+	bool elision;  // skip the key and IV writes of the loaded values
+	bool key_loaded, IV_loaded;  // the PL holds loaded.key (the round keys of the last key operation), loaded.IV
+	struct khazad_hal_ctx loaded;
+	struct khazad_hal_stats stats;
+};
+
+
+/*
+ * The counted bus accesses:
+ */
+static inline void hal_out32(struct khazad_hal *hal, const u32 addr, const u32 value) {
+	hal->stats.writes++;
+	hal->ops->out32(hal->instance, addr, value);
+}
+
+static inline void hal_out16(struct khazad_hal *hal, const u32 addr, const u16 value) {
+	hal->stats.writes++;
+	hal->ops->out16(hal->instance, addr, value);
+}
+
+static inline u32 hal_in32(struct khazad_hal *hal, const u32 addr) {
+	hal->stats.reads++;
+	return hal->ops->in32(hal->instance, addr);
+}
+
+static inline void hal_set_direction(struct khazad_hal *hal, const u32 direction) {
+	hal->stats.direction_changes++;
+	hal->ops->set_direction(hal->instance, direction);
+}
+
+static inline u32 hal_read_ready(struct khazad_hal *hal) {
+	hal->stats.polls++;
+	return hal->ops->read_ready(hal->instance);
+}
+
+static inline void hal_sleep(struct khazad_hal *hal) {
+	hal->stats.sleeps++;
+	hal->stats.sleep_time += hal->ops->sleep(hal->instance, hal->ctrl);
+}
+
+/*
+ * Big-endian data words, loaded and stored with one (unaligned) word access and a byte reverse (REV on ARM):
+ */
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define HAL_WORD(w)  __builtin_bswap32(w)
+#elif defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define HAL_WORD(w)  (w)
+#endif
+
+static inline u32 hal_load32(const u8 * const p) {
+#ifdef HAL_WORD
+	u32 w;
+
+	memcpy(&w, p, 4);
+	return HAL_WORD(w);
+#else
+	return ((u32)p[0] << 24) ^ ((u32)p[1] << 16) ^ ((u32)p[2] << 8) ^ ((u32)p[3]);
+#endif
+}
+
+static inline void hal_store32(u8 * const p, const u32 w) {
+#ifdef HAL_WORD
+	const u32 v = HAL_WORD(w);
+
+	memcpy(p, &v, 4);
+#else
+	p[0] = (u8)(w >> 24);
+	p[1] = (u8)(w >> 16);
+	p[2] = (u8)(w >> 8);
+	p[3] = (u8)w;
+#endif
+}
+
+/**
+ * Clear the bus transaction counters (between operations).
+ */
+void khazad_hal_clear_stats(struct khazad_hal *hal) {
+	memset(&hal->stats, 0, sizeof(hal->stats));
+}
+
+/**
+ * Select the completion wait mode.
+ *
+ * @param	hal			the HAL.
+ * @param	wait_mode	HAL_WAIT_POLL or HAL_WAIT_HYBRID.
+ * @param	spin_polls	HAL_WAIT_HYBRID: the number of ready flag polls before sleeping (0: sleep after one poll).
+ */
+void khazad_hal_set_wait(struct khazad_hal *hal, const u8 wait_mode, const u32 spin_polls) {
+	hal->wait_mode = wait_mode;
+	hal->spin_polls = spin_polls;
+}
+
+/**
+ * Enable or disable the key reload elision (enabled by the backend init functions).
+ */
+void khazad_hal_set_elision(struct khazad_hal *hal, const bool elision) {
+	hal->elision = elision;
+}
+
+/**
+ * Set or clear the RST bit of the PL design (all the other ctrl bits are cleared).
+ * The loaded key and IV are forgotten, so the next key operation sends its key.
+ */
+void khazad_hal_reset(struct khazad_hal *hal, const bool RST) {
+	hal->key_loaded = 0;
+	hal->IV_loaded = 0;
+	hal->ctrl = RST ? 0x0020 : 0x0000;
+	hal_out16(hal, ADDR0, hal->ctrl);
+}
+
+/*
+ * Send a data block (set GPIO_4 to output first, in the bidirectional design).
+ */
+static inline void hal_send_data(struct khazad_hal *hal, const u8 * const text) {
+#ifndef HAL_SPLIT_DATA
+	hal_set_direction(hal, HAL_DIR_OUTPUT);
+#endif
+	hal_out32(hal, ADDR4, hal_load32(text));
+	hal_out32(hal, ADDR4 + ADDR_offset, hal_load32(text + 4));
+}
+
+/*
+ * Issue the start command: toggle bit 0 of ctrl, and set bits 4..1 (only_data, enc_dec, op_mode, first_block).
+ * Can't be sent before both key & data were sent, because the key schedule would end before the data has arrived.
+ */
+static inline void hal_issue(struct khazad_hal *hal, const bool only_data, const bool enc_dec, const bool op_mode,
+							 const bool first_block) {
+	hal->ctrl = ((hal->ctrl ^ 0x0001) & 0xFFE1) | (only_data << 4) | (enc_dec << 3) | (op_mode << 2) | (first_block << 1);
+	hal_out16(hal, ADDR0, hal->ctrl);
+
+	// set GPIO_4 to input for the result, in the bidirectional design:
+#ifndef HAL_SPLIT_DATA
+	hal_set_direction(hal, HAL_DIR_INPUT);
+#endif
+}
+
+/**
+ * Start a "crypt" operation (encryption or decryption) of one data block in the PL design:
+ * send the key, the IV and the data block as needed, and issue the start command.
+ * The parameters are the same as of Zynq_crypt (KHAZAD_Zynq.h). The operation ends after khazad_hal_done
+ * returns 1 (or after khazad_hal_wait), and then its result is read by khazad_hal_result.
+ * With the key reload elision, a key operation with the loaded key runs as only_data, and the loaded IV is not sent.
+ */
+void khazad_hal_start(struct khazad_hal *hal, const u8 * const text, const u32 key1, const u32 key2, const u32 key3, const u32 key4,
+					  const u32 IV1, const u32 IV2, const bool only_data, const bool enc_dec, const bool op_mode,
+					  const bool first_block, const bool new_IV) {
+	bool key_period = only_data;
+
+	if (!only_data) {
+		if (hal->elision && hal->key_loaded && hal->loaded.key[0] == key1 && hal->loaded.key[1] == key2 &&
+			hal->loaded.key[2] == key3 && hal->loaded.key[3] == key4) {
+			key_period = 1;  // the round keys of this key are in the PL
+			hal->stats.keys_elided++;
+		}
+		else {
+			// send key:
+			hal_out32(hal, ADDR1, key1);
+			hal_out32(hal, ADDR1 + ADDR_offset, key2);
+			hal_out32(hal, ADDR2, key3);
+			hal_out32(hal, ADDR2 + ADDR_offset, key4);
+			hal->loaded.key[0] = key1;
+			hal->loaded.key[1] = key2;
+			hal->loaded.key[2] = key3;
+			hal->loaded.key[3] = key4;
+			hal->key_loaded = 1;
+			hal->stats.keys++;
+		}
+	}
+
+	if ((op_mode == 1) && (new_IV) &&
+		!(hal->elision && hal->IV_loaded && hal->loaded.IV[0] == IV1 && hal->loaded.IV[1] == IV2)) {
+		// send IV:
+		hal_out32(hal, ADDR3, IV1);
+		hal_out32(hal, ADDR3 + ADDR_offset, IV2);
+		hal->loaded.IV[0] = IV1;
+		hal->loaded.IV[1] = IV2;
+		hal->IV_loaded = 1;
+	}
+
+	hal_send_data(hal, text);
+	hal_issue(hal, key_period, enc_dec, op_mode, first_block);
+}
+
+/**
+ * Check once whether the started operation has ended.
+ *
+ * @return	1 if the ready flag = LSB of ctrl (the operation has ended), 0 if not.
+ */
+bool khazad_hal_done(struct khazad_hal *hal) {
+	return !((hal_read_ready(hal) ^ hal->ctrl) & 0x0001);
+}
+
+/**
+ * Wait until the started operation ends, in the completion wait mode of the HAL.
+ */
+void khazad_hal_wait(struct khazad_hal *hal) {
+	u32 spins = 0;
+
+	while (!khazad_hal_done(hal))  // while the ready flag != LSB of ctrl
+		if (hal->wait_mode == HAL_WAIT_HYBRID && ++spins >= hal->spin_polls)
+			hal_sleep(hal);  // until the done_IRQ interrupt
+}
+
+/**
+ * Read the result of an ended operation.
+ */
+void khazad_hal_result(struct khazad_hal *hal, u8 * const result) {
+	// read data from PL via AXI bus:
+#ifndef HAL_SPLIT_DATA
+	hal_store32(result, hal_in32(hal, ADDR4));
+	hal_store32(result + 4, hal_in32(hal, ADDR4 + ADDR_offset));
+#else
+	hal_store32(result, hal_in32(hal, ADDR5));
+	hal_store32(result + 4, hal_in32(hal, ADDR5 + ADDR_offset));
+#endif
+	hal->stats.blocks++;
+}
+
+/**
+ * Execute a "crypt" operation (encryption or decryption) of one data block in the PL design.
+ * The parameters are the same as of Zynq_crypt (KHAZAD_Zynq.h).
+ */
+void khazad_hal_crypt(struct khazad_hal *hal, const u8 * const text, const u32 key1, const u32 key2, const u32 key3, const u32 key4,
+					  const u32 IV1, const u32 IV2, const bool only_data, const bool enc_dec, const bool op_mode,
+					  const bool first_block, const bool new_IV, u8 * const result) {
+	khazad_hal_start(hal, text, key1, key2, key3, key4, IV1, IV2, only_data, enc_dec, op_mode, first_block, new_IV);
+	khazad_hal_wait(hal);
+	khazad_hal_result(hal, result);
+}
+
+/**
+ * Set up a multi-block session.
+ *
+ * @param	ctx	the session context.
+ * @param	key	the key (KEYSIZEB bytes).
+ * @param	IV	the IV (BLOCKSIZEB bytes), or NULL for ECB (a zero IV).
+ */
+void khazad_hal_ctx_init(struct khazad_hal_ctx *ctx, const u8 * const key, const u8 * const IV) {
+	int i;
+
+	for (i = 0; i < 4; i++)
+		ctx->key[i] = hal_load32(key + 4*i);
+	ctx->IV[0] = IV ? hal_load32(IV) : 0;
+	ctx->IV[1] = IV ? hal_load32(IV + 4) : 0;
+}
+
+/**
+ * Encrypt or decrypt a buffer of whole data blocks in the PL design, in ECB or CBC mode.
+ * The key (and the IV in CBC mode) is sent with the first block, unless the PL holds it already (key reload
+ * elision), and all the other blocks use only_data.
+ * In CBC mode, ctx->IV is then the last ciphertext block, so the next call continues the chain.
+ *
+ * @param	ctx			the session context (khazad_hal_ctx_init).
+ * @param	in			the input blocks (any alignment).
+ * @param	out			the output blocks (may be in).
+ * @param	nblocks		number of data blocks.
+ * @param	op_mode		1: CBC, 0: ECB.
+ * @param	enc_dec		1: encryption, 0: decryption.
+ */
+void khazad_hal_crypt_blocks(struct khazad_hal *hal, struct khazad_hal_ctx *ctx, const u8 *in, u8 *out, const u32 nblocks,
+							 const bool op_mode, const bool enc_dec) {
+	u8 last_in[BLOCKSIZEB];
+	bool sent = 0;
+	u32 i;
+
+	if (nblocks == 0)
+		return;
+	if (op_mode && !enc_dec)  // the next chaining value, before out overwrites in
+		memcpy(last_in, in + BLOCKSIZEB*(nblocks - 1), BLOCKSIZEB);
+
+	for (i = 0; i < nblocks; i++) {
+		if (i == 0)
+			khazad_hal_start(hal, in, ctx->key[0], ctx->key[1], ctx->key[2], ctx->key[3], ctx->IV[0], ctx->IV[1],
+							 0, enc_dec, op_mode, op_mode, op_mode);
+		else {
+			if (!sent)
+				hal_send_data(hal, in + BLOCKSIZEB*i);
+			hal_issue(hal, 1, enc_dec, op_mode, 0);
+		}
+#ifdef HAL_SPLIT_DATA
+		// only_data operations latch data_in at their start (key operations only after the key schedule):
+		sent = (hal->ctrl & 0x0010) && (i + 1 < nblocks);
+		if (sent)
+			hal_send_data(hal, in + BLOCKSIZEB*(i + 1));
+#endif
+		khazad_hal_wait(hal);
+		khazad_hal_result(hal, out + BLOCKSIZEB*i);
+	}
+
+	if (op_mode) {
+		const u8 *chain = enc_dec ? out + BLOCKSIZEB*(nblocks - 1) : last_in;
+
+		ctx->IV[0] = hal_load32(chain);
+		ctx->IV[1] = hal_load32(chain + 4);
+	}
+}
+
+#ifndef KHAZAD_LINUX
+/********************************************************************************************************
+  Xilinx backend
+*********************************************************************************************************/
+
+struct khazad_hal_xilinx {
+	XGpio *GPIO_4;  // AXI_GPIO_4 (d_in, and d_out in the bidirectional design)
+	XGpioPs *PS_Gpio;  // the PS GPIO (EMIO ready flag)
+#ifdef HAL_DONE_IRQ
+	XScuGic *gic;  // the GIC of the done_IRQ interrupt (NULL: no sleep, HAL_WAIT_HYBRID polls)
+	u32 irq_id;  // the done_IRQ interrupt ID
+	XScuTimer *timer;  // the SCU private timer, which bounds the sleep (its interrupt must be handled)
+	u32 timeout;  // HAL_SLEEP_TIMEOUT_US in timer counts
+#endif
+};
+
+static void hal_xilinx_out32(void *instance, const u32 addr, const u32 value) {
+	(void)instance;
+	Xil_Out32(addr, value);
+}
+
+static void hal_xilinx_out16(void *instance, const u32 addr, const u16 value) {
+	(void)instance;
+	Xil_Out16(addr, value);
+}
+
+static u32 hal_xilinx_in32(void *instance, const u32 addr) {
+	(void)instance;
+	return Xil_In32(addr);
+}
+
+static void hal_xilinx_set_direction(void *instance, const u32 direction) {
+	XGpio_SetDataDirection(((struct khazad_hal_xilinx *)instance)->GPIO_4, 1, direction);
+}
+
+static u32 hal_xilinx_read_ready(void *instance) {
+	return XGpioPs_ReadPin(((struct khazad_hal_xilinx *)instance)->PS_Gpio, HAL_READY_PIN);
+}
+
+static u64 hal_xilinx_sleep(void *instance, const u16 ctrl) {
+#ifdef HAL_DONE_IRQ
+	struct khazad_hal_xilinx *xilinx = (struct khazad_hal_xilinx *)instance;
+	XTime start = 0, end = 0;
+
+	if (!xilinx->gic)
+		return 0;  // no interrupt: the ready flag is polled again
+	Xil_ExceptionDisable();  // so the interrupt can't be taken between the ready flag check and WFI
+	// the pulses of the operations that ended while the interrupt was disabled are pending: clear them first
+	XScuGic_DistWriteReg(xilinx->gic, XSCUGIC_PENDING_CLR_OFFSET + 4*(xilinx->irq_id / 32),
+						 (u32)1 << (xilinx->irq_id % 32));
+	XScuGic_Enable(xilinx->gic, xilinx->irq_id);
+	if ((hal_xilinx_read_ready(instance) ^ ctrl) & 0x0001) {
+		XScuTimer_LoadTimer(xilinx->timer, xilinx->timeout);
+		XScuTimer_Start(xilinx->timer);  // one-shot: its interrupt ends the sleep if done_IRQ is missing
+		XTime_GetTime(&start);
+		wfi();  // a pending interrupt wakes the core up even when interrupts are disabled
+		XTime_GetTime(&end);
+		XScuTimer_Stop(xilinx->timer);
+	}
+	Xil_ExceptionEnable();  // the interrupt handler runs here
+	XScuGic_Disable(xilinx->gic, xilinx->irq_id);
+	return end - start;
+#else
+	(void)instance;
+	(void)ctrl;
+	return 0;  // the PL design has no done_IRQ: the ready flag is polled again
+#endif
+}
+
+static const struct khazad_hal_ops hal_xilinx_ops = {
+	hal_xilinx_out32, hal_xilinx_out16, hal_xilinx_in32, hal_xilinx_set_direction, hal_xilinx_read_ready,
+	hal_xilinx_sleep
+};
+
+/**
+ * Connect a HAL to the PL design, through initialized XGpio (AXI_GPIO_4) and XGpioPs instances.
+ */
+void khazad_hal_xilinx_init(struct khazad_hal *hal, struct khazad_hal_xilinx *xilinx, XGpio *GPIO_4, XGpioPs *PS_Gpio) {
+	xilinx->GPIO_4 = GPIO_4;
+	xilinx->PS_Gpio = PS_Gpio;
+	hal->ops = &hal_xilinx_ops;
+	hal->instance = xilinx;
+	hal->ctrl = 0;
+	hal->key_loaded = 0;
+	hal->IV_loaded = 0;
+	khazad_hal_set_elision(hal, 1);
+	khazad_hal_set_wait(hal, HAL_WAIT_POLL, HAL_SPIN_POLLS);
+	khazad_hal_clear_stats(hal);
+#ifdef HAL_DONE_IRQ
+	xilinx->gic = NULL;
+#endif
+}
+
+#ifdef HAL_DONE_IRQ
+/**
+ * Let the Xilinx backend sleep in HAL_WAIT_HYBRID mode, on the done_IRQ interrupt of controller.v.
+ * The interrupt must be connected to its handler (and left disabled: the backend enables it while sleeping).
+ *
+ * @param	gic		the initialized GIC.
+ * @param	irq_id	the done_IRQ interrupt ID (IRQ_F2P[0]: 61).
+ * @param	timer	the initialized SCU private timer, with its interrupt connected to a handler that clears
+ * 					its interrupt status, and enabled.
+ */
+void khazad_hal_xilinx_set_irq(struct khazad_hal_xilinx *xilinx, XScuGic *gic, const u32 irq_id, XScuTimer *timer) {
+	xilinx->irq_id = irq_id;
+	xilinx->timer = timer;
+	xilinx->timeout = HAL_SLEEP_TIMEOUT_US * (XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ / 2 / 1000000);  // CPU clock / 2
+	XScuTimer_DisableAutoReload(timer);
+	XScuTimer_EnableInterrupt(timer);
+	xilinx->gic = gic;
+}
+#endif
+#endif
+
+
+/********************************************************************************************************
+  Model backends
+*********************************************************************************************************/
+
+struct khazad_hal_model {
+	// AXI_GPIO registers:
+	u32 key[4];  // AXI_GPIO_1, AXI_GPIO_2
+	u32 IV[2];  // AXI_GPIO_3
+	u32 d_in[2];  // AXI_GPIO_4, written by the PS
+	u32 direction;  // AXI_GPIO_4 (bidirectional design)
+	u16 ctrl_from_PS;  // AXI_GPIO_0
+	// controller.v:
+	u8 ctrl_to_PS;
+	bool busy;  // start_condition, before the finish pulse
+	// enveloped_KHAZAD.v:
+	struct NESSIEstruct subkeys;  // the round keys of KHAZAD.v
+	u64 d_out;  // the output to AXI_GPIO_4 (to AXI_GPIO_5 with HAL_SPLIT_DATA)
+	u64 next_d_out;  // d_out at the end of the current operation
+	u64 d_out_KHAZAD;  // the last KHAZAD output (Cminus1 of op_mode_enc)
+	u64 mem_buffer, Cminus1;  // CBC_dec_memory
+	// cycle model:
+	bool timed;
+	u32 axi_cycles, poll_cycles, irq_cycles;
+	u64 *clock;  // the PL clock (hal->stats.cycles)
+	u64 done;  // the clock at the end of the current operation
+};
+
+static void hal_model_tick(struct khazad_hal_model *model, const u32 cycles) {
+	if (model->timed)
+		*model->clock += cycles;
+	if (model->busy && *model->clock >= model->done) {  // finish pulse
+		model->ctrl_to_PS = model->ctrl_from_PS & 0x0001;
+		model->d_out = model->next_d_out;
+		model->busy = 0;
+	}
+}
+
+/*
+ * The start pulse: the operation of enveloped_KHAZAD.v on the current inputs.
+ */
+static void hal_model_start(struct khazad_hal_model *model) {
+	bool only_data = (model->ctrl_from_PS >> 4) & 1, enc = (model->ctrl_from_PS >> 3) & 1;
+	bool CBC = (model->ctrl_from_PS >> 2) & 1, first_block = (model->ctrl_from_PS >> 1) & 1;
+	u64 d_in = ((u64)model->d_in[0] << 32) ^ model->d_in[1], IV = ((u64)model->IV[0] << 32) ^ model->IV[1], data;
+	u8 block[BLOCKSIZEB], key[KEYSIZEB];
+	int i;
+
+	if (!only_data) {  // key schedule
+		for (i = 0; i < 4; i++) {
+			key[4*i] = (u8)(model->key[i] >> 24);
+			key[4*i + 1] = (u8)(model->key[i] >> 16);
+			key[4*i + 2] = (u8)(model->key[i] >> 8);
+			key[4*i + 3] = (u8)model->key[i];
+		}
+		NESSIEkeysetup(key, &model->subkeys);
+	}
+
+	// op_mode_enc:
+	data = d_in;
+	if (enc && CBC)
+		data ^= first_block ? IV : model->d_out_KHAZAD;
+
+	// KHAZAD:
+	U64TO8_BIG(block, data);
+	if (enc)
+		NESSIEencrypt64(&model->subkeys, block, block);
+	else
+		NESSIEdecrypt64(&model->subkeys, block, block);
+	data = U8TO64_BIG(block);
+	model->d_out_KHAZAD = data;
+
+	// CBC_dec_memory (every start pulse) and op_mode_dec:
+	model->Cminus1 = model->mem_buffer;
+	model->mem_buffer = d_in;
+	if (!enc && CBC)
+		data ^= first_block ? IV : model->Cminus1;
+
+	model->next_d_out = data;
+	model->busy = 1;
+	model->done = *model->clock + (model->timed ? (only_data ? HAL_CYCLES_DATA : HAL_CYCLES_KEY) : 0);
+}
+
+static void hal_model_out32(void *instance, const u32 addr, const u32 value) {
+	struct khazad_hal_model *model = (struct khazad_hal_model *)instance;
+
+	hal_model_tick(model, model->axi_cycles);
+	switch (addr) {
+	case ADDR1:					model->key[0] = value; break;
+	case ADDR1 + ADDR_offset:	model->key[1] = value; break;
+	case ADDR2:					model->key[2] = value; break;
+	case ADDR2 + ADDR_offset:	model->key[3] = value; break;
+	case ADDR3:					model->IV[0] = value; break;
+	case ADDR3 + ADDR_offset:	model->IV[1] = value; break;
+	case ADDR4:					model->d_in[0] = value; break;
+	case ADDR4 + ADDR_offset:	model->d_in[1] = value; break;
+	default:					break;
+	}
+}
+
+static void hal_model_out16(void *instance, const u32 addr, const u16 value) {
+	struct khazad_hal_model *model = (struct khazad_hal_model *)instance;
+
+	hal_model_tick(model, model->axi_cycles);
+	if (addr != ADDR0)
+		return;
+	model->ctrl_from_PS = value & 0x003F;
+	if (model->ctrl_from_PS & 0x0020) {  // RST
+		model->ctrl_to_PS = 0;
+		model->busy = 0;
+		model->d_out = model->d_out_KHAZAD = 0;
+		model->mem_buffer = model->Cminus1 = 0;
+	}
+	else if (!model->busy && ((model->ctrl_from_PS ^ model->ctrl_to_PS) & 0x0001))  // start_condition
+		hal_model_start(model);
+	hal_model_tick(model, 0);
+}
+
+static u32 hal_model_in32(void *instance, const u32 addr) {
+	struct khazad_hal_model *model = (struct khazad_hal_model *)instance;
+
+	hal_model_tick(model, model->axi_cycles);
+	switch (addr) {
+	case ADDR1:					return model->key[0];
+	case ADDR1 + ADDR_offset:	return model->key[1];
+	case ADDR2:					return model->key[2];
+	case ADDR2 + ADDR_offset:	return model->key[3];
+	case ADDR3:					return model->IV[0];
+	case ADDR3 + ADDR_offset:	return model->IV[1];
+	case ADDR4:					return model->direction ? (u32)(model->d_out >> 32) : model->d_in[0];
+	case ADDR4 + ADDR_offset:	return model->direction ? (u32)model->d_out : model->d_in[1];
+	case ADDR5:					return (u32)(model->d_out >> 32);
+	case ADDR5 + ADDR_offset:	return (u32)model->d_out;
+	default:					return model->ctrl_from_PS;
+	}
+}
+
+static void hal_model_set_direction(void *instance, const u32 direction) {
+	struct khazad_hal_model *model = (struct khazad_hal_model *)instance;
+
+	hal_model_tick(model, model->axi_cycles);
+	model->direction = direction;
+}
+
+static u32 hal_model_read_ready(void *instance) {
+	struct khazad_hal_model *model = (struct khazad_hal_model *)instance;
+
+	hal_model_tick(model, model->poll_cycles);
+	return model->ctrl_to_PS;
+}
+
+/*
+ * WFI: the clock runs until the end of the operation (the done_IRQ pulse), and the interrupt latency.
+ */
+static u64 hal_model_sleep(void *instance, const u16 ctrl) {
+	struct khazad_hal_model *model = (struct khazad_hal_model *)instance;
+	u64 start = *model->clock;
+
+	if (!model->timed || !((model->ctrl_to_PS ^ ctrl) & 0x0001) || !model->busy)
+		return 0;  // no interrupt to wait for
+	*model->clock = model->done + model->irq_cycles;
+	hal_model_tick(model, 0);
+	return *model->clock - start;
+}
+
+static const struct khazad_hal_ops hal_model_ops = {
+	hal_model_out32, hal_model_out16, hal_model_in32, hal_model_set_direction, hal_model_read_ready,
+	hal_model_sleep
+};
+
+/**
+ * Connect a HAL to a software model of the PL design, in its reset state.
+ *
+ * @param	hal		the HAL.
+ * @param	model	the model state.
+ * @param	timed	0: the model backend (operations end immediately), 1: the cycle model backend,
+ * 					with the default costs HAL_AXI_CYCLES, HAL_POLL_CYCLES and HAL_IRQ_CYCLES (model->axi_cycles,
+ * 					model->poll_cycles and model->irq_cycles may be changed after the call).
+ */
+void khazad_hal_model_init(struct khazad_hal *hal, struct khazad_hal_model *model, const bool timed) {
+	memset(model, 0, sizeof(*model));
+	model->timed = timed;
+	model->axi_cycles = HAL_AXI_CYCLES;
+	model->poll_cycles = HAL_POLL_CYCLES;
+	model->irq_cycles = HAL_IRQ_CYCLES;
+	model->clock = &hal->stats.cycles;
+	hal->ops = &hal_model_ops;
+	hal->instance = model;
+	hal->ctrl = 0;
+	hal->key_loaded = 0;
+	hal->IV_loaded = 0;
+	khazad_hal_set_elision(hal, 1);
+	khazad_hal_set_wait(hal, HAL_WAIT_POLL, HAL_SPIN_POLLS);
+	khazad_hal_clear_stats(hal);
+}
+
+#endif   /* KHAZAD_HAL_H */
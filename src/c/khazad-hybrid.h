@@ -0,0 +1,242 @@
+#ifndef KHAZAD_HYBRID_H
+#define KHAZAD_HYBRID_H
+/********************************************************************************************************
+*********************************************************************************************************
+Zynq-7000 based Implementation of the KHAZAD Block Cipher
+Yossef Shitzer & Efraim Wasserman
+Jerusalem College of Technology - Lev Academic Center (JCT)
+Department of electrical and electronic engineering
+2018
+*********************************************************************************************************
+*********************************************************************************************************
+This file implements a hybrid HW+SW dispatcher: one buffer of data blocks is processed by the PL design
+(through the hardware access layer, "khazad-hal.h") and by the software engine ("khazad-tweak64.h",
+"khazad-bulk.h") at the same time, for the modes without a serial dependency:
+ECB encryption/decryption, CTR, and CBC decryption.
+The PL takes blocks from the front of the buffer, one operation at a time (ECB in the PL; the CTR and CBC XORs
+are done by the PS), and the PS takes slices from the back of the buffer while each PL operation runs,
+until the two ends meet. The driver itself keeps the PS busy during the bus accesses of a PL operation,
+so only the PL wait (from the start command to the ready flag) is free for software blocks:
+	hw_bus   - the PS time of the bus accesses of one PL block,
+	hw_wait  - the time from the start command to the ready flag,
+	sw_block - the time of one software block.
+Every PL operation adds hw_wait to a time credit, and the PS encrypts as many software blocks as the credit
+pays for, so the PL is kept busy and the PS works in its waits: (1 + hw_wait/sw_block) blocks per
+(hw_bus + hw_wait), which is more than the PL alone. When sw_block <= hw_bus the PS computes a block faster than
+it feeds one to the PL, and the whole buffer is processed by the software engine.
+The times are measured by khazad_hybrid_calibrate (with the time source hybrid->now), or set by hand.
+Usage:
+	struct khazad_hybrid hybrid;
+	khazad_hybrid_init(&hybrid, &hal, now);
+	khazad_hybrid_calibrate(&hybrid, &subkeys, &ctx);
+	khazad_hybrid_crypt(&hybrid, &subkeys, &ctx, KHAZAD_HYBRID_CTR, input, output, counter, blocks);
+	hybrid.hw_blocks, hybrid.sw_blocks ...
+*********************************************************************************************************
+*********************************************************************************************************/
+
+#include <string.h>
+#include <stdbool.h>
+#include "nessie_modified.h"
+#include "khazad-tweak64.h"
+#include "khazad-bulk.h"
+#include "khazad-hal.h"
+
+// modes:
+#define KHAZAD_HYBRID_ENCRYPT      0  // ECB encryption
+#define KHAZAD_HYBRID_DECRYPT      1  // ECB decryption
+#define KHAZAD_HYBRID_CTR          2
+#define KHAZAD_HYBRID_CBC_DECRYPT  3
+
+// number of data blocks of each side in khazad_hybrid_calibrate:
+#ifndef HYBRID_CALIBRATION_BLOCKS
+#define HYBRID_CALIBRATION_BLOCKS  64
+#endif
+
+struct khazad_hybrid {
+	struct khazad_hal *hal;
+	u64 (*now)(void);  // time source (any unit: global timer ticks, nanoseconds...)
+	u32 hw_bus;  // PS time of the bus accesses of one PL block
+	u32 hw_wait;  // time from the start command to the ready flag
+	u32 sw_block;  // time of one software block
+	u32 hw_blocks;  // blocks of the last call processed by the PL
+	u32 sw_blocks;  // blocks of the last call processed by the software engine
+};
+
+
+/**
+ * Initialize a dispatcher on a HAL. Before the calibration, all the blocks are processed by the PL.
+ *
+ * @param	now	the time source of khazad_hybrid_calibrate (may be NULL if the times are set by hand).
+ */
+void khazad_hybrid_init(struct khazad_hybrid *hybrid, struct khazad_hal *hal, u64 (*now)(void)) {
+	hybrid->hal = hal;
+	hybrid->now = now;
+	hybrid->hw_bus = 0;
+	hybrid->hw_wait = 0;
+	hybrid->sw_block = 0;
+	hybrid->hw_blocks = 0;
+	hybrid->sw_blocks = 0;
+}
+
+/**
+ * Measure hw_bus, hw_wait and sw_block, with HYBRID_CALIBRATION_BLOCKS ECB encryptions of each side
+ * (the key operation of the PL is not counted).
+ *
+ * @param	subkeys	the expanded key (for the software engine).
+ * @param	ctx		the same key, for the PL.
+ */
+void khazad_hybrid_calibrate(struct khazad_hybrid *hybrid, const struct NESSIEstruct * const subkeys,
+							 const struct khazad_hal_ctx * const ctx) {
+	u8 buffer[HYBRID_CALIBRATION_BLOCKS*BLOCKSIZEB] = {0};
+	u64 t0, t1, t2, t3, bus = 0, wait = 0;
+	u32 i;
+
+	if (!hybrid->now)
+		return;
+	for (i = 0; i <= HYBRID_CALIBRATION_BLOCKS; i++) {
+		t0 = hybrid->now();
+		khazad_hal_start(hybrid->hal, buffer, ctx->key[0], ctx->key[1], ctx->key[2], ctx->key[3], 0, 0,
+						 i != 0, 1, 0, 0, 0);
+		t1 = hybrid->now();
+		khazad_hal_wait(hybrid->hal);
+		t2 = hybrid->now();
+		khazad_hal_result(hybrid->hal, buffer);
+		t3 = hybrid->now();
+		if (i != 0) {
+			bus += (t1 - t0) + (t3 - t2);
+			wait += t2 - t1;
+		}
+	}
+	t0 = hybrid->now();
+	NESSIEencrypt_blocks(subkeys, buffer, buffer, HYBRID_CALIBRATION_BLOCKS);
+	t1 = hybrid->now();
+
+	hybrid->hw_bus = (u32)(bus / HYBRID_CALIBRATION_BLOCKS);
+	hybrid->hw_wait = (u32)(wait / HYBRID_CALIBRATION_BLOCKS);
+	hybrid->sw_block = (u32)((t1 - t0) / HYBRID_CALIBRATION_BLOCKS);
+	if (hybrid->sw_block == 0)
+		hybrid->sw_block = 1;
+}
+
+/*
+ * Software blocks first, ..., first + blocks - 1.
+ *
+ * @param	chain	CBC decryption: the ciphertext block before block first (or the IV).
+ * @param	counter	CTR: the counter block of block 0.
+ */
+static void hybrid_sw(const struct NESSIEstruct * const subkeys, const int mode, const u8 *input, u8 *output,
+					  const u8 *chain, const u64 counter, const u32 first, const u32 blocks) {
+	u8 block[BLOCKSIZEB];
+
+	input += BLOCKSIZEB*first;
+	output += BLOCKSIZEB*first;
+	switch (mode) {
+	case KHAZAD_HYBRID_ENCRYPT:
+		NESSIEencrypt_blocks(subkeys, input, output, blocks);
+		break;
+	case KHAZAD_HYBRID_DECRYPT:
+		NESSIEdecrypt_blocks(subkeys, input, output, blocks);
+		break;
+	case KHAZAD_HYBRID_CTR:
+		U64TO8_BIG(block, counter + first);
+		NESSIEcrypt_CTR_bulk(subkeys, block, input, output, blocks);
+		break;
+	default:
+		memcpy(block, chain, BLOCKSIZEB);
+		NESSIEdecrypt_CBC_blocks(subkeys, input, block, output, blocks);
+		break;
+	}
+}
+
+/**
+ * Process a buffer of data blocks by the PL and the software engine together.
+ *
+ * @param	subkeys	the expanded key (from NESSIEkeysetup), for the software engine.
+ * @param	ctx		the same key, for the PL (ctx->IV is not used).
+ * @param	mode	KHAZAD_HYBRID_ENCRYPT, KHAZAD_HYBRID_DECRYPT, KHAZAD_HYBRID_CTR or KHAZAD_HYBRID_CBC_DECRYPT.
+ * @param	input	the data blocks.
+ * @param	output	the resulting data blocks (either the same buffer as input, or not overlapping it).
+ * @param	IV		CTR: the counter block (64-bit big-endian) of the first block, updated to the counter block
+ * 					of the next block. CBC decryption: the IV, or the last ciphertext block of the previous
+ * 					buffer, updated to the last ciphertext block of this buffer. ECB: not used (may be NULL).
+ * @param	blocks	number of data blocks.
+ */
+void khazad_hybrid_crypt(struct khazad_hybrid *hybrid, const struct NESSIEstruct * const subkeys,
+						 const struct khazad_hal_ctx * const ctx, const int mode, const u8 * const input,
+						 u8 * const output, u8 * const IV, const u32 blocks) {
+	struct khazad_hal *hal = hybrid->hal;
+	const bool enc_dec = (mode == KHAZAD_HYBRID_ENCRYPT || mode == KHAZAD_HYBRID_CTR);
+	u8 chain[BLOCKSIZEB], current[BLOCKSIZEB], last[BLOCKSIZEB], block[BLOCKSIZEB];
+	u64 counter = 0, credit = 0;
+	u32 front = 0, back = blocks, n;
+	bool running = 0;
+	int k;
+
+	hybrid->hw_blocks = 0;
+	hybrid->sw_blocks = 0;
+	if (blocks == 0)
+		return;
+	if (mode == KHAZAD_HYBRID_CTR)
+		counter = U8TO64_BIG(IV);
+	if (mode == KHAZAD_HYBRID_CBC_DECRYPT) {
+		memcpy(chain, IV, BLOCKSIZEB);  // the ciphertext block before the next PL block
+		memcpy(last, input + BLOCKSIZEB*(blocks - 1), BLOCKSIZEB);  // before it may be overwritten (in place)
+	}
+
+	if (hybrid->sw_block && hybrid->sw_block <= hybrid->hw_bus) {
+		// the software engine alone is faster:
+		hybrid_sw(subkeys, mode, input, output, chain, counter, 0, blocks);
+		hybrid->sw_blocks = blocks;
+		back = 0;
+	}
+
+	while (front < back || running) {
+		if (!running && front < back) {
+			// start a PL block (the key is sent with the first one, unless the PL holds it already):
+			if (mode == KHAZAD_HYBRID_CTR)
+				U64TO8_BIG(current, counter + front);
+			else
+				memcpy(current, input + BLOCKSIZEB*front, BLOCKSIZEB);
+			khazad_hal_start(hal, current, ctx->key[0], ctx->key[1], ctx->key[2], ctx->key[3], 0, 0,
+							 hybrid->hw_blocks != 0, enc_dec, 0, 0, 0);
+			front++;
+			running = 1;
+			credit += hybrid->hw_wait;
+		}
+
+		// software blocks from the back, in the PL wait (the block before them is the running PL block, or not processed yet):
+		n = hybrid->sw_block ? (u32)(credit / hybrid->sw_block) : 0;
+		if (n > back - front)
+			n = back - front;
+		if (n) {
+			hybrid_sw(subkeys, mode, input, output, (back - n == front) ? current : input + BLOCKSIZEB*(back - n - 1),
+					  counter, back - n, n);
+			back -= n;
+			credit -= (u64)n*hybrid->sw_block;
+			hybrid->sw_blocks += n;
+		}
+
+		if (running) {
+			khazad_hal_wait(hal);
+			khazad_hal_result(hal, block);
+			for (k = 0; k < BLOCKSIZEB; k++) {
+				if (mode == KHAZAD_HYBRID_CTR)
+					block[k] ^= input[BLOCKSIZEB*(front - 1) + k];
+				else if (mode == KHAZAD_HYBRID_CBC_DECRYPT)
+					block[k] ^= chain[k];
+			}
+			memcpy(output + BLOCKSIZEB*(front - 1), block, BLOCKSIZEB);
+			if (mode == KHAZAD_HYBRID_CBC_DECRYPT)
+				memcpy(chain, current, BLOCKSIZEB);
+			running = 0;
+			hybrid->hw_blocks++;
+		}
+	}
+
+	if (mode == KHAZAD_HYBRID_CTR)
+		U64TO8_BIG(IV, counter + blocks);
+	if (mode == KHAZAD_HYBRID_CBC_DECRYPT)
+		memcpy(IV, last, BLOCKSIZEB);
+}
+
+#endif   /* KHAZAD_HYBRID_H */
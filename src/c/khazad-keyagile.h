@@ -0,0 +1,194 @@
+#ifndef KHAZAD_KEYAGILE_H
+#define KHAZAD_KEYAGILE_H
+/********************************************************************************************************
+*********************************************************************************************************
+Zynq-7000 based Implementation of the KHAZAD Block Cipher
+Yossef Shitzer & Efraim Wasserman
+Jerusalem College of Technology - Lev Academic Center (JCT)
+Department of electrical and electronic engineering
+2018
+*********************************************************************************************************
+*********************************************************************************************************
+This file implements a key-agile software version of KHAZAD, for workloads that change the key for every
+data block (e.g. set 4 of the test vectors, hashing modes, per-record keys).
+NESSIEkeysetup computes both the encryption and the decryption key schedules, and the decryption round keys
+cost double table lookups (U0[S[...] & 0xff]). Here:
+NESSIEencrypt_keyagile - computes each encryption round key on the fly, in the same round as the data,
+		so the key and the data lookups are independent and run in parallel, and no schedule is stored.
+NESSIEkeysetup_encrypt - computes the encryption key schedule only (with the 64-bit tables).
+NESSIEkeysetup_decrypt - adds the decryption key schedule, only when it is needed. The inverse round keys
+		theta(K^{R-r}) are computed without tables: the byte permutations x[j^d] of the dyadic matrix H
+		are byte swaps (as in "khazad-compact.h"), and the multiplication is done in Horner form on all
+		the 8 bytes at once (SWAR), as in the bitsliced implementation ("khazad-bitslice.h").
+NESSIEdecrypt_keyagile - computes the encryption round keys forward, and then decrypts with the inverse
+		round keys computed on the fly.
+*********************************************************************************************************
+*********************************************************************************************************/
+
+#include "nessie_modified.h"
+#include "khazad-tweak64.h"
+#include "khazad-compact.h"
+
+/*
+ * The round constants c^r (as c[R+1][2] of "khazad-tweak32.h"), as 64-bit words:
+ */
+static const u64 keyagile_c[R + 1] = {
+	0xba542f7453d3d24dULL, 0x50ac8dbf70529a4cULL, 0xead597d133515ba6ULL,
+	0xde48a899db32b7fcULL, 0xe39e919be2bb416eULL, 0xa5cb6b95a1f3b102ULL,
+	0xccc41d14c363da5dULL, 0x5fdc7dcd7f5a6c5cULL, 0xf726ffede89d6f8eULL,
+};
+
+
+/**
+ * One round without the key addition (gamma and theta), using the 64-bit tables.
+ */
+static inline u64 keyagile_round(const u64 s) {
+	return
+		T0[(int)(s >> 56)       ] ^
+		T1[(int)(s >> 48) & 0xff] ^
+		T2[(int)(s >> 40) & 0xff] ^
+		T3[(int)(s >> 32) & 0xff] ^
+		T4[(int)(s >> 24) & 0xff] ^
+		T5[(int)(s >> 16) & 0xff] ^
+		T6[(int)(s >>  8) & 0xff] ^
+		T7[(int)(s      ) & 0xff];
+}
+
+/**
+ * The last round without the key addition (gamma only).
+ */
+static inline u64 keyagile_last_round(const u64 s) {
+	return
+		(T0[(int)(s >> 56)       ] & 0xff00000000000000ULL) ^
+		(T1[(int)(s >> 48) & 0xff] & 0x00ff000000000000ULL) ^
+		(T2[(int)(s >> 40) & 0xff] & 0x0000ff0000000000ULL) ^
+		(T3[(int)(s >> 32) & 0xff] & 0x000000ff00000000ULL) ^
+		(T4[(int)(s >> 24) & 0xff] & 0x00000000ff000000ULL) ^
+		(T5[(int)(s >> 16) & 0xff] & 0x0000000000ff0000ULL) ^
+		(T6[(int)(s >>  8) & 0xff] & 0x000000000000ff00ULL) ^
+		(T7[(int)(s      ) & 0xff] & 0x00000000000000ffULL);
+}
+
+/**
+ * Multiplication by 2 over GF(2^8) of each of the 8 bytes (reduction polynomial 0x11D).
+ */
+static inline u64 keyagile_xtime(const u64 x) {
+	return ((x & 0x7f7f7f7f7f7f7f7fULL) << 1) ^ (((x >> 7) & 0x0101010101010101ULL) * 0x1D);
+}
+
+/**
+ * Linear diffusion layer theta, without tables.
+ * Output byte j = sum over d of coef[d] * x[j^d], with coef = 1,3,4,5,6,8,B,7 (row 0 of theta.v).
+ */
+static inline u64 keyagile_theta(const u64 x) {
+	u64 x1, x2, x3, x4, x5, x6, x7;
+
+	x1 = compact_swap8(x);
+	x2 = compact_swap16(x);
+	x3 = compact_swap16(x1);
+	x4 = compact_swap32(x);
+	x5 = compact_swap32(x1);
+	x6 = compact_swap32(x2);
+	x7 = compact_swap32(x3);
+
+	return x ^ x1 ^ x3 ^ x6 ^ x7 ^						// A0: coefficients with bit 0 (1,3,5,B,7)
+		keyagile_xtime(x1 ^ x4 ^ x6 ^ x7 ^				// A1: coefficients with bit 1 (3,6,B,7)
+		keyagile_xtime(x2 ^ x3 ^ x4 ^ x7 ^				// A2: coefficients with bit 2 (4,5,6,7)
+		keyagile_xtime(x5 ^ x6)));						// A3: coefficients with bit 3 (8,B)
+}
+
+/**
+ * Compute the encryption key schedule only (roundKeyDec is not written).
+ *
+ * @param	key				the 128-bit cipher key.
+ * @param	structpointer	the expanded key.
+ */
+void NESSIEkeysetup_encrypt(const unsigned char * const key,
+							struct NESSIEstruct * const structpointer) {
+	u64 K2 = U8TO64_BIG(key), K1 = U8TO64_BIG(key + 8), K;
+	int r;
+
+	for (r = 0; r <= R; r++) {
+		K = keyagile_round(K1) ^ keyagile_c[r] ^ K2;  // K^r = rho[c^r](K^{r-1}) ^ K^{r-2}
+		structpointer->roundKeyEnc[r][0] = (u32)(K >> 32);
+		structpointer->roundKeyEnc[r][1] = (u32)K;
+		K2 = K1;
+		K1 = K;
+	}
+}
+
+/**
+ * Compute the decryption key schedule from the encryption key schedule:
+ * K'^0 = K^R, K'^R = K^0, K'^r = theta(K^{R-r}).
+ *
+ * @param	structpointer	the expanded key, after NESSIEkeysetup_encrypt.
+ */
+void NESSIEkeysetup_decrypt(struct NESSIEstruct * const structpointer) {
+	u64 K;
+	int r;
+
+	structpointer->roundKeyDec[0][0] = structpointer->roundKeyEnc[R][0];
+	structpointer->roundKeyDec[0][1] = structpointer->roundKeyEnc[R][1];
+	for (r = 1; r < R; r++) {
+		K = keyagile_theta(((u64)structpointer->roundKeyEnc[R - r][0] << 32) ^ structpointer->roundKeyEnc[R - r][1]);
+		structpointer->roundKeyDec[r][0] = (u32)(K >> 32);
+		structpointer->roundKeyDec[r][1] = (u32)K;
+	}
+	structpointer->roundKeyDec[R][0] = structpointer->roundKeyEnc[0][0];
+	structpointer->roundKeyDec[R][1] = structpointer->roundKeyEnc[0][1];
+}
+
+/**
+ * Encrypt one data block with its own key, computing the round keys on the fly.
+ *
+ * @param	key			the 128-bit cipher key.
+ * @param	plaintext	the data block to be encrypted.
+ * @param	ciphertext	the encrypted data block (may be the same as plaintext).
+ */
+void NESSIEencrypt_keyagile(const unsigned char * const key,
+							const unsigned char * const plaintext,
+							      unsigned char * const ciphertext) {
+	u64 K2 = U8TO64_BIG(key), K1 = U8TO64_BIG(key + 8), K, state;
+	int r;
+
+	K = keyagile_round(K1) ^ keyagile_c[0] ^ K2;  // K^0
+	state = U8TO64_BIG(plaintext) ^ K;
+	for (r = 1; r < R; r++) {
+		K2 = K1;
+		K1 = K;
+		K = keyagile_round(K1) ^ keyagile_c[r] ^ K2;  // K^r, independent of the data round
+		state = keyagile_round(state) ^ K;
+	}
+	K = keyagile_round(K) ^ keyagile_c[R] ^ K1;  // K^R
+	state = keyagile_last_round(state) ^ K;
+	U64TO8_BIG(ciphertext, state);
+}
+
+/**
+ * Decrypt one data block with its own key. The encryption round keys are computed first
+ * (the decryption starts with K^R), and the inverse round keys are computed on the fly.
+ *
+ * @param	key			the 128-bit cipher key.
+ * @param	ciphertext	the data block to be decrypted.
+ * @param	plaintext	the decrypted data block (may be the same as ciphertext).
+ */
+void NESSIEdecrypt_keyagile(const unsigned char * const key,
+							const unsigned char * const ciphertext,
+							      unsigned char * const plaintext) {
+	u64 K2 = U8TO64_BIG(key), K1 = U8TO64_BIG(key + 8), K[R + 1], state;
+	int r;
+
+	for (r = 0; r <= R; r++) {
+		K[r] = keyagile_round(K1) ^ keyagile_c[r] ^ K2;
+		K2 = K1;
+		K1 = K[r];
+	}
+
+	state = U8TO64_BIG(ciphertext) ^ K[R];
+	for (r = 1; r < R; r++)
+		state = keyagile_round(state) ^ keyagile_theta(K[R - r]);
+	state = keyagile_last_round(state) ^ K[0];
+	U64TO8_BIG(plaintext, state);
+}
+
+#endif   /* KHAZAD_KEYAGILE_H */
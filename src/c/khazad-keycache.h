@@ -0,0 +1,199 @@
+#ifndef KHAZAD_KEYCACHE_H
+#define KHAZAD_KEYCACHE_H
+/********************************************************************************************************
+*********************************************************************************************************
+Zynq-7000 based Implementation of the KHAZAD Block Cipher
+Yossef Shitzer & Efraim Wasserman
+Jerusalem College of Technology - Lev Academic Center (JCT)
+Department of electrical and electronic engineering
+2018
+*********************************************************************************************************
+*********************************************************************************************************
+This file implements a key schedule cache: a hash table of 128-bit keys and their expanded
+round keys (NESSIEstruct), so repeated key setups of the same key are replaced by a lookup.
+The table is statically allocated, with a bounded size of KEYCACHE_SLOTS entries, organized as a
+set-associative cache of KEYCACHE_WAYS entries per set. A new key replaces the least recently used
+entry of its set.
+keycache_lookup returns a handle, which is used for keycache_encrypt / keycache_decrypt.
+A handle holds the entry generation, so after the entry is replaced by another key, the handle becomes
+invalid (the calls return -1), and the key should be looked up again.
+The cache is not thread-safe.
+*********************************************************************************************************
+*********************************************************************************************************/
+
+#include <string.h>
+#include "nessie_modified.h"
+
+// number of cached key schedules (a power of 2), about 170 bytes each:
+#ifndef KEYCACHE_SLOTS
+#define KEYCACHE_SLOTS  1024
+#endif
+
+// number of entries per set (a power of 2, not more than KEYCACHE_SLOTS):
+#ifndef KEYCACHE_WAYS
+#define KEYCACHE_WAYS  8
+#endif
+
+#define KEYCACHE_SETS  (KEYCACHE_SLOTS/KEYCACHE_WAYS)
+
+#if (KEYCACHE_SLOTS & (KEYCACHE_SLOTS - 1)) || (KEYCACHE_WAYS & (KEYCACHE_WAYS - 1)) || (KEYCACHE_WAYS > KEYCACHE_SLOTS)
+#error "KEYCACHE_SLOTS and KEYCACHE_WAYS must be powers of 2, and KEYCACHE_WAYS <= KEYCACHE_SLOTS"
+#endif
+
+struct keycache_entry {
+	u8 key[KEYSIZEB];
+	u8 valid;
+	u32 generation;  // incremented whenever the entry is replaced or cleared
+	u32 last_use;  // for the LRU replacement
+	struct NESSIEstruct schedule;
+};
+
+struct keycache_handle {
+	u32 slot;
+	u32 generation;
+};
+
+struct keycache_stats {
+	u32 hits;
+	u32 misses;
+	u32 evictions;
+};
+
+static struct keycache_entry keycache_table[KEYCACHE_SLOTS];
+static struct keycache_stats keycache_counters;
+static u32 keycache_clock = 0;
+
+
+/**
+ * Hash a 128-bit key to a set index (multiplicative hashing of the four 32-bit words,
+ * and a final mix, so that keys of a repeated byte are also spread over all the sets).
+ */
+static u32 keycache_hash(const u8 key[KEYSIZEB]) {
+	u32 h = 0, w;
+	int i;
+
+	for (i = 0; i < KEYSIZEB; i += 4) {
+		w = ((u32)key[i] << 24) ^ ((u32)key[i + 1] << 16) ^ ((u32)key[i + 2] << 8) ^ (u32)key[i + 3];
+		h = (h ^ w) * 0x9E3779B1U;
+		h = (h << 13) | (h >> 19);
+	}
+	h ^= h >> 16;
+	h *= 0x85EBCA6BU;
+	h ^= h >> 13;
+	h *= 0xC2B2AE35U;
+	h ^= h >> 16;
+	return h & (KEYCACHE_SETS - 1);
+}
+
+/**
+ * Find the key schedule of a key, or calculate and store it.
+ *
+ * @param	key		the 128-bit key.
+ * @return	a handle to the cached key schedule.
+ */
+struct keycache_handle keycache_lookup(const u8 key[KEYSIZEB]) {
+	struct keycache_handle handle;
+	struct keycache_entry *entry;
+	u32 set = keycache_hash(key)*KEYCACHE_WAYS, victim = set, w;
+
+	for (w = set; w < set + KEYCACHE_WAYS; w++) {
+		entry = &keycache_table[w];
+		if (entry->valid && memcmp(entry->key, key, KEYSIZEB) == 0) {
+			keycache_counters.hits++;
+			entry->last_use = ++keycache_clock;
+			handle.slot = w;
+			handle.generation = entry->generation;
+			return handle;
+		}
+		// victim: an empty entry, or else the least recently used one
+		if (keycache_table[victim].valid &&
+			(!entry->valid || (s32)(entry->last_use - keycache_table[victim].last_use) < 0))
+			victim = w;
+	}
+
+	keycache_counters.misses++;
+	entry = &keycache_table[victim];
+	if (entry->valid)
+		keycache_counters.evictions++;
+	memcpy(entry->key, key, KEYSIZEB);
+	NESSIEkeysetup(key, &entry->schedule);
+	entry->valid = 1;
+	entry->generation++;
+	entry->last_use = ++keycache_clock;
+
+	handle.slot = victim;
+	handle.generation = entry->generation;
+	return handle;
+}
+
+/**
+ * The key schedule of a handle.
+ *
+ * @param	handle	a handle from keycache_lookup.
+ * @return	the expanded key, or NULL if the entry was replaced by another key.
+ */
+const struct NESSIEstruct *keycache_schedule(const struct keycache_handle handle) {
+	if (handle.slot >= KEYCACHE_SLOTS || !keycache_table[handle.slot].valid ||
+		keycache_table[handle.slot].generation != handle.generation)
+		return NULL;
+	return &keycache_table[handle.slot].schedule;
+}
+
+/**
+ * Encrypt a data block with a cached key schedule.
+ *
+ * @param	handle		a handle from keycache_lookup.
+ * @param	plaintext	the data block to be encrypted.
+ * @param	ciphertext	the encrypted data block.
+ * @return	0 on success, -1 if the handle is no longer valid.
+ */
+int keycache_encrypt(const struct keycache_handle handle, const u8 * const plaintext, u8 * const ciphertext) {
+	const struct NESSIEstruct *schedule = keycache_schedule(handle);
+
+	if (schedule == NULL)
+		return -1;
+	NESSIEencrypt(schedule, plaintext, ciphertext);
+	return 0;
+}
+
+/**
+ * Decrypt a data block with a cached key schedule.
+ *
+ * @param	handle		a handle from keycache_lookup.
+ * @param	ciphertext	the data block to be decrypted.
+ * @param	plaintext	the decrypted data block.
+ * @return	0 on success, -1 if the handle is no longer valid.
+ */
+int keycache_decrypt(const struct keycache_handle handle, const u8 * const ciphertext, u8 * const plaintext) {
+	const struct NESSIEstruct *schedule = keycache_schedule(handle);
+
+	if (schedule == NULL)
+		return -1;
+	NESSIEdecrypt(schedule, ciphertext, plaintext);
+	return 0;
+}
+
+/**
+ * Remove all the cached keys (e.g. before the memory is released to another tenant),
+ * and reset the statistics. All handles become invalid.
+ */
+void keycache_clear(void) {
+	u32 w;
+
+	for (w = 0; w < KEYCACHE_SLOTS; w++) {
+		memset(keycache_table[w].key, 0, KEYSIZEB);
+		memset(&keycache_table[w].schedule, 0, sizeof(struct NESSIEstruct));
+		keycache_table[w].valid = 0;
+		keycache_table[w].generation++;  // the old handles never match again
+	}
+	memset(&keycache_counters, 0, sizeof(keycache_counters));
+}
+
+/**
+ * The cache statistics since the last keycache_clear.
+ */
+struct keycache_stats keycache_statistics(void) {
+	return keycache_counters;
+}
+
+#endif   /* KHAZAD_KEYCACHE_H */
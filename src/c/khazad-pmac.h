@@ -0,0 +1,193 @@
+#ifndef KHAZAD_PMAC_H
+#define KHAZAD_PMAC_H
+/********************************************************************************************************
+*********************************************************************************************************
+Zynq-7000 based Implementation of the KHAZAD Block Cipher
+Yossef Shitzer & Efraim Wasserman
+Jerusalem College of Technology - Lev Academic Center (JCT)
+Department of electrical and electronic engineering
+2018
+*********************************************************************************************************
+*********************************************************************************************************
+This file implements PMAC (the parallelizable MAC of Black and Rogaway, PMAC1) with KHAZAD.
+Unlike CBC-MAC, where every block encryption waits for the previous one, the block encryptions of PMAC
+are independent:
+	L = E(0), L(j) = L * x^j over GF(2^64), modulo x^64 + x^4 + x^3 + x + 1
+	offset_i = offset_{i-1} ^ L(ntz(i))  (ntz - number of trailing zero bits)
+	Sigma = E(M_1 ^ offset_1) ^ ... ^ E(M_{m-1} ^ offset_{m-1}) ^ last
+	last = M_m ^ L * x^-1 for a whole last block, or M_m || 10...0 for a partial (or empty) last block
+	tag = E(Sigma)
+So the blocks are encrypted in chunks of BULK_CHUNK_BLOCKS by the interleaved multi-block function
+NESSIEencrypt_blocks ("khazad-tweak64.h"), and when KHAZAD_LINUX is defined, large messages are split
+between up to BULK_THREADS POSIX threads (as NESSIEdecrypt_CBC_bulk in "khazad-bulk.h"):
+the offset of any block is gray(i) * L, so every part starts independently, and the sums are XORed.
+Usage:
+	khazad_pmac(&subkeys, message, length, tag);
+*********************************************************************************************************
+*********************************************************************************************************/
+
+#include <string.h>
+#include "nessie_modified.h"
+#include "khazad-tweak64.h"
+#include "khazad-bulk.h"
+
+// number of L(j) values (ntz(i) < 32 for the 32-bit block indexes):
+#define PMAC_LEVELS  32
+
+
+/**
+ * Multiplication by x over GF(2^64).
+ */
+static inline u64 pmac_double(const u64 a) {
+	return (a << 1) ^ ((0 - (a >> 63)) & 0x1B);
+}
+
+/**
+ * Multiplication by x^-1 over GF(2^64).
+ */
+static inline u64 pmac_half(const u64 a) {
+	return (a >> 1) ^ ((0 - (a & 1)) & 0x800000000000000DULL);
+}
+
+static inline u32 pmac_ntz(u32 i) {
+	u32 n = 0;
+
+	for (; !(i & 1); i >>= 1)
+		n++;
+	return n;
+}
+
+/**
+ * Compute L(j) = E(0) * x^j, and E(0) * x^-1.
+ */
+static void pmac_offsets(const struct NESSIEstruct * const structpointer, u64 L[PMAC_LEVELS], u64 *L_inv) {
+	u8 block[BLOCKSIZEB] = {0};
+	int j;
+
+	NESSIEencrypt64(structpointer, block, block);
+	L[0] = U8TO64_BIG(block);
+	for (j = 1; j < PMAC_LEVELS; j++)
+		L[j] = pmac_double(L[j - 1]);
+	*L_inv = pmac_half(L[0]);
+}
+
+/**
+ * The sum of E(M_i ^ offset_i) for the message blocks first, ..., first + blocks - 1 (first >= 1).
+ *
+ * @param	structpointer	the expanded key.
+ * @param	L				the L(j) values.
+ * @param	message			block number first of the message.
+ * @param	first			the index of the first block.
+ * @param	blocks			number of data blocks.
+ */
+static u64 pmac_sum(const struct NESSIEstruct * const structpointer, const u64 L[PMAC_LEVELS],
+					const u8 *message, const u32 first, const u32 blocks) {
+	u8 buffer[BULK_CHUNK_BLOCKS*BLOCKSIZEB];
+	u64 offset = 0, sigma = 0;
+	u32 gray = (first - 1) ^ ((first - 1) >> 1), i, k, n;
+	int j;
+
+	// offset_{first-1} = gray(first - 1) * L:
+	for (j = 0; gray; j++, gray >>= 1)
+		if (gray & 1)
+			offset ^= L[j];
+
+	for (i = 0; i < blocks; i += n) {
+		n = (blocks - i < BULK_CHUNK_BLOCKS) ? blocks - i : BULK_CHUNK_BLOCKS;
+		for (k = 0; k < n; k++) {
+			offset ^= L[pmac_ntz(first + i + k)];
+			U64TO8_BIG(buffer + BLOCKSIZEB*k, U8TO64_BIG(message + BLOCKSIZEB*(i + k)) ^ offset);
+		}
+		NESSIEencrypt_blocks(structpointer, buffer, buffer, n);
+		for (k = 0; k < n; k++)
+			sigma ^= U8TO64_BIG(buffer + BLOCKSIZEB*k);
+	}
+	return sigma;
+}
+
+#ifdef KHAZAD_LINUX
+// one part of a message, summed by one thread:
+struct pmac_job {
+	const struct NESSIEstruct *structpointer;
+	const u64 *L;
+	const u8 *message;
+	u32 first;
+	u32 blocks;
+	u64 sigma;
+};
+
+static void *pmac_thread(void *arg) {
+	struct pmac_job *job = (struct pmac_job *)arg;
+
+	job->sigma = pmac_sum(job->structpointer, job->L, job->message, job->first, job->blocks);
+	return NULL;
+}
+#endif
+
+/**
+ * Compute the PMAC of a message.
+ *
+ * @param	structpointer	the expanded key (from NESSIEkeysetup or NESSIEkeysetup_encrypt).
+ * @param	message			the message.
+ * @param	length			number of bytes (any length, including 0).
+ * @param	tag				the MAC (BLOCKSIZEB bytes).
+ */
+void khazad_pmac(const struct NESSIEstruct * const structpointer, const u8 * const message, const u32 length,
+				 u8 * const tag) {
+	u64 L[PMAC_LEVELS], L_inv, sigma = 0;
+	u8 last[BLOCKSIZEB] = {0};
+	u32 blocks = (length == 0) ? 0 : (length - 1)/BLOCKSIZEB;  // all the blocks before the last one
+	u32 residue = length - BLOCKSIZEB*blocks;
+
+	pmac_offsets(structpointer, L, &L_inv);
+
+#ifdef KHAZAD_LINUX
+	if (blocks >= 2*BULK_THREAD_MIN_BLOCKS) {
+		struct pmac_job job[BULK_THREADS];
+		pthread_t thread[BULK_THREADS];
+		bool created[BULK_THREADS];
+		u32 threads, first, t;
+
+		threads = blocks / BULK_THREAD_MIN_BLOCKS;
+		if (threads > BULK_THREADS)
+			threads = BULK_THREADS;
+		for (t = 0, first = 0; t < threads; t++) {
+			job[t].structpointer = structpointer;
+			job[t].L = L;
+			job[t].message = message + BLOCKSIZEB*first;
+			job[t].first = first + 1;
+			job[t].blocks = blocks / threads + (t < blocks % threads);
+			first += job[t].blocks;
+		}
+
+		for (t = 1; t < threads; t++)
+			created[t] = (pthread_create(&thread[t], NULL, pmac_thread, &job[t]) == 0);
+		pmac_thread(&job[0]);  // the first part in the calling thread
+		sigma = job[0].sigma;
+		for (t = 1; t < threads; t++) {
+			if (created[t])
+				pthread_join(thread[t], NULL);
+			else
+				pmac_thread(&job[t]);  // thread creation failed: sum this part here
+			sigma ^= job[t].sigma;
+		}
+	}
+	else
+#endif
+		sigma = pmac_sum(structpointer, L, message, 1, blocks);
+
+	// the last block:
+	if (residue)
+		memcpy(last, message + BLOCKSIZEB*blocks, residue);
+	if (residue == BLOCKSIZEB)
+		sigma ^= U8TO64_BIG(last) ^ L_inv;
+	else {
+		last[residue] = 0x80;
+		sigma ^= U8TO64_BIG(last);
+	}
+
+	U64TO8_BIG(tag, sigma);
+	NESSIEencrypt64(structpointer, tag, tag);
+}
+
+#endif   /* KHAZAD_PMAC_H */
@@ -0,0 +1,409 @@
+#ifndef KHAZAD_POOL_H
+#define KHAZAD_POOL_H
+/********************************************************************************************************
+*********************************************************************************************************
+Zynq-7000 based Implementation of the KHAZAD Block Cipher
+Yossef Shitzer & Efraim Wasserman
+Jerusalem College of Technology - Lev Academic Center (JCT)
+Department of electrical and electronic engineering
+2018
+*********************************************************************************************************
+*********************************************************************************************************
+This file implements a multi-threaded bulk engine for Linux (on the Zynq PS cores, or on x86 hosts).
+Requires KHAZAD_LINUX and POSIX threads (compile with -DKHAZAD_LINUX -pthread).
+A buffer is split into chunks of BULK_CHUNK_BLOCKS data blocks ("khazad-bulk.h"), and the chunks are processed
+by a pool of persistent worker threads, all sharing one read-only NESSIEstruct.
+Every worker owns a queue (a range of chunk indexes): it takes chunks from the front of its own range,
+and when its range is empty, it steals the back half of the largest remaining range of another worker,
+so the load is balanced even when some cores are slower or busy.
+The calling thread works as worker 0, so a pool of 1 thread runs the job without any thread switch.
+Supported modes: ECB encryption/decryption, CTR, and CBC decryption (CBC encryption is sequential by nature).
+Usage:
+	struct khazad_pool pool;
+	khazad_pool_init(&pool, 0);	// 0 - one thread per online core
+	khazad_pool_ecb(&pool, &subkeys, KHAZAD_POOL_ENCRYPT, plaintext, ciphertext, blocks);
+	khazad_pool_destroy(&pool);
+*********************************************************************************************************
+*********************************************************************************************************/
+
+#ifndef KHAZAD_LINUX
+#error "khazad-pool.h requires KHAZAD_LINUX (POSIX threads)"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/sysinfo.h>  // get_nprocs (not <unistd.h>, whose crypt() conflicts with khazad-tweak32.h)
+#include <pthread.h>
+#include "nessie_modified.h"
+#include "khazad-tweak64.h"
+#include "khazad-bulk.h"
+
+// maximal number of threads in a pool:
+#ifndef KHAZAD_POOL_MAX_THREADS
+#define KHAZAD_POOL_MAX_THREADS  64
+#endif
+
+// job types:
+#define KHAZAD_POOL_ENCRYPT      0
+#define KHAZAD_POOL_DECRYPT      1
+#define KHAZAD_POOL_CTR          2
+#define KHAZAD_POOL_CBC_DECRYPT  3
+
+// the queue of one worker - the chunk indexes [next, end):
+struct khazad_pool_queue {
+	pthread_mutex_t lock;
+	u32 next;
+	u32 end;
+};
+
+// one job (one buffer):
+struct khazad_pool_job {
+	int type;
+	const struct NESSIEstruct *structpointer;
+	const u8 *input;
+	u8 *output;
+	u32 blocks;
+	u64 counter;  // CTR: counter value of the first block
+	const u8 *chain;  // CBC decryption: chaining value of every chunk
+};
+
+struct khazad_pool;
+
+// argument of a worker thread:
+struct khazad_pool_worker {
+	struct khazad_pool *pool;
+	u32 index;
+};
+
+struct khazad_pool {
+	u32 threads;  // including the calling thread
+	pthread_t thread[KHAZAD_POOL_MAX_THREADS];
+	struct khazad_pool_worker worker[KHAZAD_POOL_MAX_THREADS];
+	struct khazad_pool_queue queue[KHAZAD_POOL_MAX_THREADS];
+	pthread_mutex_t lock;  // protects the fields below
+	pthread_cond_t start;
+	pthread_cond_t done;
+	u32 generation;  // incremented for every job
+	u32 running;  // number of workers still working on the current job
+	int stop;
+	struct khazad_pool_job job;
+};
+
+
+/**
+ * Process one chunk of the current job.
+ *
+ * @param	job		the current job.
+ * @param	chunk	the chunk index.
+ */
+static void khazad_pool_chunk(const struct khazad_pool_job *job, const u32 chunk) {
+	u32 first = chunk*BULK_CHUNK_BLOCKS;
+	u32 n = (job->blocks - first < BULK_CHUNK_BLOCKS) ? job->blocks - first : BULK_CHUNK_BLOCKS;
+	const u8 *in = job->input + BLOCKSIZEB*first;
+	u8 *out = job->output + BLOCKSIZEB*first;
+
+	switch (job->type) {
+	case KHAZAD_POOL_ENCRYPT:
+		NESSIEencrypt_blocks(job->structpointer, in, out, n);
+		break;
+	case KHAZAD_POOL_DECRYPT:
+		NESSIEdecrypt_blocks(job->structpointer, in, out, n);
+		break;
+	case KHAZAD_POOL_CTR:
+		bulk_ctr_chunk(job->structpointer, job->counter + first, in, out, n);
+		break;
+	case KHAZAD_POOL_CBC_DECRYPT:
+		bulk_cbc_decrypt(job->structpointer, in, job->chain + BLOCKSIZEB*chunk, out, n);
+		break;
+	}
+}
+
+/**
+ * Take the next chunk of a worker: from the front of its own queue, or else steal
+ * the back half of the largest queue of the other workers.
+ *
+ * @param	pool	the pool.
+ * @param	index	the worker index.
+ * @param	chunk	the chunk index to be processed.
+ * @return	0 if a chunk was taken, -1 if no chunks are left.
+ */
+static int khazad_pool_take(struct khazad_pool *pool, const u32 index, u32 *chunk) {
+	struct khazad_pool_queue *own = &pool->queue[index], *victim;
+	u32 t, size, largest, steal;
+
+	for (;;) {
+		pthread_mutex_lock(&own->lock);
+		if (own->next < own->end) {
+			*chunk = own->next++;
+			pthread_mutex_unlock(&own->lock);
+			return 0;
+		}
+		pthread_mutex_unlock(&own->lock);
+
+		// find a victim (the sizes are only a hint, they are checked again under the victim lock):
+		victim = NULL;
+		largest = 0;
+		for (t = 0; t < pool->threads; t++) {
+			if (t == index)
+				continue;
+			pthread_mutex_lock(&pool->queue[t].lock);
+			size = pool->queue[t].end - pool->queue[t].next;
+			pthread_mutex_unlock(&pool->queue[t].lock);
+			if (size > largest) {
+				largest = size;
+				victim = &pool->queue[t];
+			}
+		}
+		if (victim == NULL)
+			return -1;  // all the queues are empty
+
+		pthread_mutex_lock(&victim->lock);
+		size = victim->end - victim->next;
+		if (size == 0) {
+			pthread_mutex_unlock(&victim->lock);
+			continue;  // emptied meanwhile, look again
+		}
+		steal = (size + 1)/2;
+		victim->end -= steal;
+		pthread_mutex_lock(&own->lock);
+		own->next = victim->end;
+		own->end = victim->end + steal;
+		pthread_mutex_unlock(&own->lock);
+		pthread_mutex_unlock(&victim->lock);
+	}
+}
+
+/**
+ * Process chunks of the current job until no chunks are left.
+ */
+static void khazad_pool_work(struct khazad_pool *pool, const u32 index) {
+	u32 chunk;
+
+	while (khazad_pool_take(pool, index, &chunk) == 0)
+		khazad_pool_chunk(&pool->job, chunk);
+}
+
+/**
+ * Worker thread main loop: wait for a job, process it, and report.
+ */
+static void *khazad_pool_thread(void *arg) {
+	struct khazad_pool_worker *worker = (struct khazad_pool_worker *)arg;
+	struct khazad_pool *pool = worker->pool;
+	u32 generation = 0;
+
+	for (;;) {
+		pthread_mutex_lock(&pool->lock);
+		while (pool->generation == generation && !pool->stop)
+			pthread_cond_wait(&pool->start, &pool->lock);
+		if (pool->stop) {
+			pthread_mutex_unlock(&pool->lock);
+			return NULL;
+		}
+		generation = pool->generation;
+		pthread_mutex_unlock(&pool->lock);
+
+		khazad_pool_work(pool, worker->index);
+
+		pthread_mutex_lock(&pool->lock);
+		if (--pool->running == 0)
+			pthread_cond_signal(&pool->done);
+		pthread_mutex_unlock(&pool->lock);
+	}
+}
+
+/**
+ * Run a job on the pool, and return when it is completed.
+ * The chunks are distributed evenly between the queues, and rebalanced by stealing.
+ */
+static void khazad_pool_run(struct khazad_pool *pool, const struct khazad_pool_job *job) {
+	u32 chunks = (job->blocks + BULK_CHUNK_BLOCKS - 1)/BULK_CHUNK_BLOCKS;
+	u32 t, first = 0, n;
+
+	if (chunks == 0)
+		return;
+
+	pthread_mutex_lock(&pool->lock);
+	pool->job = *job;
+	for (t = 0; t < pool->threads; t++) {
+		n = chunks/pool->threads + (t < chunks % pool->threads);
+		pthread_mutex_lock(&pool->queue[t].lock);
+		pool->queue[t].next = first;
+		pool->queue[t].end = first + n;
+		pthread_mutex_unlock(&pool->queue[t].lock);
+		first += n;
+	}
+	pool->running = pool->threads - 1;
+	pool->generation++;
+	pthread_cond_broadcast(&pool->start);
+	pthread_mutex_unlock(&pool->lock);
+
+	khazad_pool_work(pool, 0);  // the calling thread is worker 0
+
+	pthread_mutex_lock(&pool->lock);
+	while (pool->running != 0)
+		pthread_cond_wait(&pool->done, &pool->lock);
+	pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * Stop and join the worker threads 1..(created-1), and release the pool resources.
+ */
+static void khazad_pool_stop(struct khazad_pool *pool, const u32 created) {
+	u32 t;
+
+	pthread_mutex_lock(&pool->lock);
+	pool->stop = 1;
+	pthread_cond_broadcast(&pool->start);
+	pthread_mutex_unlock(&pool->lock);
+	for (t = 1; t < created; t++)
+		pthread_join(pool->thread[t], NULL);
+
+	for (t = 0; t < KHAZAD_POOL_MAX_THREADS; t++)
+		pthread_mutex_destroy(&pool->queue[t].lock);
+	pthread_cond_destroy(&pool->done);
+	pthread_cond_destroy(&pool->start);
+	pthread_mutex_destroy(&pool->lock);
+}
+
+/**
+ * Create the worker threads of a pool.
+ *
+ * @param	pool	the pool to be initialized.
+ * @param	threads	number of threads, including the calling thread. 0 - one thread per online core.
+ * @return	0 on success, -1 if a thread could not be created.
+ */
+int khazad_pool_init(struct khazad_pool *pool, u32 threads) {
+	int cores;
+	u32 t;
+
+	if (threads == 0) {
+		cores = get_nprocs();
+		threads = (cores > 0) ? (u32)cores : 1;
+	}
+	if (threads > KHAZAD_POOL_MAX_THREADS)
+		threads = KHAZAD_POOL_MAX_THREADS;
+
+	memset(pool, 0, sizeof(*pool));
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_cond_init(&pool->start, NULL);
+	pthread_cond_init(&pool->done, NULL);
+	for (t = 0; t < KHAZAD_POOL_MAX_THREADS; t++)
+		pthread_mutex_init(&pool->queue[t].lock, NULL);
+
+	pool->threads = threads;
+	for (t = 1; t < threads; t++) {
+		pool->worker[t].pool = pool;
+		pool->worker[t].index = t;
+		if (pthread_create(&pool->thread[t], NULL, khazad_pool_thread, &pool->worker[t]) != 0) {
+			khazad_pool_stop(pool, t);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Stop the worker threads of a pool.
+ */
+void khazad_pool_destroy(struct khazad_pool *pool) {
+	khazad_pool_stop(pool, pool->threads);
+}
+
+/**
+ * ECB encryption or decryption of a buffer of data blocks on the pool.
+ *
+ * @param	pool			the pool.
+ * @param	structpointer	the expanded key (from NESSIEkeysetup).
+ * @param	direction		KHAZAD_POOL_ENCRYPT or KHAZAD_POOL_DECRYPT.
+ * @param	input			the data blocks to be encrypted/decrypted.
+ * @param	output			the resulting data blocks (may be the same buffer as input).
+ * @param	blocks			number of data blocks.
+ */
+void khazad_pool_ecb(struct khazad_pool *pool, const struct NESSIEstruct * const structpointer,
+					 const int direction, const u8 * const input, u8 * const output, const u32 blocks) {
+	struct khazad_pool_job job;
+
+	memset(&job, 0, sizeof(job));
+	job.type = (direction == KHAZAD_POOL_DECRYPT) ? KHAZAD_POOL_DECRYPT : KHAZAD_POOL_ENCRYPT;
+	job.structpointer = structpointer;
+	job.input = input;
+	job.output = output;
+	job.blocks = blocks;
+	khazad_pool_run(pool, &job);
+}
+
+/**
+ * CTR mode encryption (or decryption) of a buffer of data blocks on the pool.
+ * Gives the same results as NESSIEcrypt_CTR_bulk.
+ *
+ * @param	pool			the pool.
+ * @param	structpointer	the expanded key (from NESSIEkeysetup).
+ * @param	counter			the counter block (64-bit big-endian) of the first data block.
+ * 							Updated to the counter block of the next data block, for the next call.
+ * @param	input			the data blocks (plaintext or ciphertext).
+ * @param	output			the resulting data blocks (may be the same buffer as input).
+ * @param	blocks			number of data blocks.
+ */
+void khazad_pool_ctr(struct khazad_pool *pool, const struct NESSIEstruct * const structpointer,
+					 u8 * const counter, const u8 * const input, u8 * const output, const u32 blocks) {
+	struct khazad_pool_job job;
+
+	memset(&job, 0, sizeof(job));
+	job.type = KHAZAD_POOL_CTR;
+	job.structpointer = structpointer;
+	job.input = input;
+	job.output = output;
+	job.blocks = blocks;
+	job.counter = U8TO64_BIG(counter);
+	khazad_pool_run(pool, &job);
+	U64TO8_BIG(counter, job.counter + blocks);
+}
+
+/**
+ * CBC decryption of a buffer of data blocks on the pool.
+ * Gives the same results as NESSIEdecrypt_CBC_bulk.
+ *
+ * @param	pool			the pool.
+ * @param	structpointer	the expanded key (from NESSIEkeysetup).
+ * @param	CBC_Xor			the IV, or the last ciphertext block of the previous buffer.
+ * 							Updated to the last ciphertext block of this buffer, for chaining the next call.
+ * @param	ciphertext		the data blocks to be decrypted.
+ * @param	plaintext		the decrypted data blocks (either the same buffer as ciphertext, or not overlapping it).
+ * @param	blocks			number of data blocks.
+ * @return	0 on success, -1 if the chaining values could not be allocated (the buffer is then decrypted
+ * 			by the calling thread only).
+ */
+int khazad_pool_cbc_decrypt(struct khazad_pool *pool, const struct NESSIEstruct * const structpointer,
+							u8 * const CBC_Xor, const u8 * const ciphertext, u8 * const plaintext, const u32 blocks) {
+	struct khazad_pool_job job;
+	u32 chunks = (blocks + BULK_CHUNK_BLOCKS - 1)/BULK_CHUNK_BLOCKS, c;
+	u8 *chain;
+
+	if (blocks == 0)
+		return 0;
+	chain = (u8 *)malloc(BLOCKSIZEB*chunks);
+	if (chain == NULL) {
+		NESSIEdecrypt_CBC_bulk(structpointer, ciphertext, CBC_Xor, plaintext, blocks);
+		return -1;
+	}
+
+	// take the chaining value of every chunk before the plaintext is written (in place):
+	memcpy(chain, CBC_Xor, BLOCKSIZEB);
+	for (c = 1; c < chunks; c++)
+		memcpy(chain + BLOCKSIZEB*c, ciphertext + BLOCKSIZEB*(c*BULK_CHUNK_BLOCKS - 1), BLOCKSIZEB);
+	memcpy(CBC_Xor, ciphertext + BLOCKSIZEB*(blocks - 1), BLOCKSIZEB);
+
+	memset(&job, 0, sizeof(job));
+	job.type = KHAZAD_POOL_CBC_DECRYPT;
+	job.structpointer = structpointer;
+	job.input = ciphertext;
+	job.output = plaintext;
+	job.blocks = blocks;
+	job.chain = chain;
+	khazad_pool_run(pool, &job);
+
+	free(chain);
+	return 0;
+}
+
+#endif   /* KHAZAD_POOL_H */
@@ -0,0 +1,140 @@
+#ifndef KHAZAD_QUEUE_H
+#define KHAZAD_QUEUE_H
+/********************************************************************************************************
+*********************************************************************************************************
+Zynq-7000 based Implementation of the KHAZAD Block Cipher
+Yossef Shitzer & Efraim Wasserman
+Jerusalem College of Technology - Lev Academic Center (JCT)
+Department of electrical and electronic engineering
+2018
+*********************************************************************************************************
+*********************************************************************************************************
+This file implements an asynchronous job queue for the PL design, over the hardware access layer
+("khazad-hal.h"). A job is one "crypt" operation, with the parameters of Zynq_crypt.
+Jobs are kept in a ring of QUEUE_JOBS entries, and run in the PL one after the other, in submission order
+(so CBC chains and key periods work as with Zynq_crypt). Submitting a job returns at once with a ticket,
+and the PS may do other work (prepare the next blocks, print, compute references) while the PL computes.
+The queue advances when the PS calls khazad_queue_poll (non-blocking: one ready flag read, and when the
+running job has ended, its result is read and the next job is started) or khazad_queue_wait (blocking),
+so long PS work should call khazad_queue_poll now and then to keep the PL busy.
+The input block of a job is read when the job starts, and its result is written when it ends, so the input
+may be the result of an earlier job in the queue.
+Usage:
+	struct khazad_queue queue;
+	khazad_queue_init(&queue, &hal);
+	ticket = khazad_queue_submit(&queue, &job);
+	...		// PS work, khazad_queue_poll(&queue)
+	khazad_queue_wait(&queue, ticket);
+*********************************************************************************************************
+*********************************************************************************************************/
+
+#include <stdbool.h>
+#include "nessie_modified.h"
+#include "khazad-hal.h"
+
+// number of jobs in the ring (a power of 2):
+#ifndef QUEUE_JOBS
+#define QUEUE_JOBS  16
+#endif
+
+struct khazad_job {
+	const u8 *text;  // the input data block
+	u8 *result;  // the output data block
+	u32 key1, key2, key3, key4;
+	u32 IV1, IV2;
+	bool only_data, enc_dec, op_mode, first_block, new_IV;  // as in Zynq_crypt
+};
+
+struct khazad_queue {
+	struct khazad_hal *hal;
+	struct khazad_job ring[QUEUE_JOBS];
+	u32 submitted;  // number of submitted jobs (the ticket of the last job)
+	u32 completed;  // number of completed jobs
+	bool running;  // job number completed is running in the PL
+};
+
+
+/**
+ * Initialize an empty job queue on a HAL.
+ */
+void khazad_queue_init(struct khazad_queue *queue, struct khazad_hal *hal) {
+	queue->hal = hal;
+	queue->submitted = 0;
+	queue->completed = 0;
+	queue->running = 0;
+}
+
+/**
+ * Whether a job has completed.
+ *
+ * @param	ticket	the ticket of the job (from khazad_queue_submit).
+ */
+static inline bool khazad_queue_done(const struct khazad_queue *queue, const u32 ticket) {
+	return (int)(queue->completed - ticket) >= 0;
+}
+
+/*
+ * Start the next job of the queue, if any.
+ */
+static void queue_start_next(struct khazad_queue *queue) {
+	const struct khazad_job *job;
+
+	if (queue->running || queue->completed == queue->submitted)
+		return;
+	job = &queue->ring[queue->completed % QUEUE_JOBS];
+	khazad_hal_start(queue->hal, job->text, job->key1, job->key2, job->key3, job->key4, job->IV1, job->IV2,
+					 job->only_data, job->enc_dec, job->op_mode, job->first_block, job->new_IV);
+	queue->running = 1;
+}
+
+/*
+ * Complete the running job (after its end), and start the next one.
+ */
+static void queue_complete(struct khazad_queue *queue) {
+	khazad_hal_result(queue->hal, queue->ring[queue->completed % QUEUE_JOBS].result);
+	queue->completed++;
+	queue->running = 0;
+	queue_start_next(queue);
+}
+
+/**
+ * Advance the queue without waiting: if the running job has ended, read its result and start the next job.
+ *
+ * @return	the number of completed jobs (the ticket of the last completed job).
+ */
+u32 khazad_queue_poll(struct khazad_queue *queue) {
+	if (queue->running && khazad_hal_done(queue->hal))
+		queue_complete(queue);
+	return queue->completed;
+}
+
+/**
+ * Wait until a job has completed (the jobs before it complete first).
+ *
+ * @param	ticket	the ticket of the job, or queue->submitted to wait for all the jobs.
+ */
+void khazad_queue_wait(struct khazad_queue *queue, const u32 ticket) {
+	while (!khazad_queue_done(queue, ticket) && queue->running) {
+		khazad_hal_wait(queue->hal);  // in the completion wait mode of the HAL
+		queue_complete(queue);
+	}
+}
+
+/**
+ * Submit a job. If the queue is idle, the job starts at once. If the ring is full, the function first waits
+ * for the oldest job to complete.
+ *
+ * @param	job	the job parameters (copied into the ring; the input and output blocks must stay valid
+ * 				until the job completes).
+ * @return	the ticket of the job, for khazad_queue_done and khazad_queue_wait.
+ */
+u32 khazad_queue_submit(struct khazad_queue *queue, const struct khazad_job * const job) {
+	if (queue->submitted - queue->completed == QUEUE_JOBS)
+		khazad_queue_wait(queue, queue->completed + 1);
+	queue->ring[queue->submitted % QUEUE_JOBS] = *job;
+	queue->submitted++;
+	queue_start_next(queue);
+	return queue->submitted;
+}
+
+#endif   /* KHAZAD_QUEUE_H */
@@ -0,0 +1,213 @@
+#ifndef KHAZAD_SIMD_H
+#define KHAZAD_SIMD_H
+/********************************************************************************************************
+*********************************************************************************************************
+Zynq-7000 based Implementation of the KHAZAD Block Cipher
+Yossef Shitzer & Efraim Wasserman
+Jerusalem College of Technology - Lev Academic Center (JCT)
+Department of electrical and electronic engineering
+2018
+*********************************************************************************************************
+*********************************************************************************************************
+This file implements a SIMD software version of KHAZAD, using the GCC portable vector extensions,
+so the same source is compiled to SSSE3/AVX2 on x86 Linux hosts and to NEON on the Cortex-A9
+(compile with -mssse3 or -mfpu=neon, otherwise GCC emulates the vector operations with scalar code).
+Each vector holds SIMD_BLOCKS data blocks (2 blocks in a 16-byte vector, or 4 blocks when KHAZAD_SIMD_BYTES=32).
+gamma - the S-box is computed as in S_box.v: three layers of 4-bit "P" and "Q" mini-boxes.
+		Each mini-box is a 16-entry byte shuffle (pshufb / vtbl) of a nibble vector.
+theta - the multiplications by the coefficients 1,3,4,5,6,8,B,7 (poly_mult.v) are computed from
+		vectorized multiplications by 2 (xtime: shift and conditional XOR with 0x1D).
+		Since the matrix H is dyadic, the input byte j^d is moved to position j by a constant byte shuffle,
+		and each output byte is computed in Horner form: A0 ^ 2*(A1 ^ 2*(A2 ^ 2*A3)),
+		as in the bitsliced implementation ("khazad-bitslice.h").
+The key schedule is shared with the reference code (NESSIEkeysetup), and the results are identical.
+Requires GCC (__builtin_shuffle with a variable mask).
+*********************************************************************************************************
+*********************************************************************************************************/
+
+#include <string.h>
+#include "nessie_modified.h"
+
+#if !defined(__GNUC__) || defined(__clang__)
+#error "khazad-simd.h requires the GCC vector extensions (__builtin_shuffle)"
+#endif
+
+// vector size in bytes: 16 (SSE / NEON q-register) or 32 (AVX2):
+#ifndef KHAZAD_SIMD_BYTES
+#define KHAZAD_SIMD_BYTES  16
+#endif
+
+// number of data blocks in one vector:
+#define SIMD_BLOCKS  (KHAZAD_SIMD_BYTES/BLOCKSIZEB)
+
+// number of independent vectors processed together in each round:
+#define SIMD_INTERLEAVE  4
+
+typedef u8 simd_u8 __attribute__ ((vector_size (KHAZAD_SIMD_BYTES)));
+
+// byte indexes i^d inside each 8-byte block, for the theta byte shuffles:
+#define SIMD_XOR8(o, d)  (o)+(0^(d)), (o)+(1^(d)), (o)+(2^(d)), (o)+(3^(d)), \
+						 (o)+(4^(d)), (o)+(5^(d)), (o)+(6^(d)), (o)+(7^(d))
+// a 16-entry table, replicated to the vector size:
+#define SIMD_TABLE16(a,b,c,d,e,f,g,h,i,j,k,l,m,n,o,p)  a,b,c,d,e,f,g,h,i,j,k,l,m,n,o,p
+
+#if KHAZAD_SIMD_BYTES == 16
+#define SIMD_XOR(d)  ((simd_u8){SIMD_XOR8(0, d), SIMD_XOR8(8, d)})
+#define SIMD_REP(t)  {t}
+#elif KHAZAD_SIMD_BYTES == 32
+#define SIMD_XOR(d)  ((simd_u8){SIMD_XOR8(0, d), SIMD_XOR8(8, d), SIMD_XOR8(16, d), SIMD_XOR8(24, d)})
+#define SIMD_REP(t)  {t, t}
+#else
+#error "KHAZAD_SIMD_BYTES must be 16 or 32"
+#endif
+
+// P and Q mini-boxes, as the truth tables of P_mini_box.v and Q_mini_box.v:
+static const simd_u8 simd_P = SIMD_REP(SIMD_TABLE16(0x3, 0xF, 0xE, 0x0, 0x5, 0x4, 0xB, 0xC, 0xD, 0xA, 0x9, 0x6, 0x7, 0x8, 0x2, 0x1));
+static const simd_u8 simd_Q = SIMD_REP(SIMD_TABLE16(0x9, 0xE, 0x5, 0x6, 0xA, 0x2, 0x3, 0xC, 0xF, 0x0, 0x4, 0xD, 0x7, 0xB, 0x1, 0x8));
+
+
+/**
+ * Nonlinear layer gamma: S-box on each byte, using three layers of mini-boxes (same wiring as S_box.v).
+ *
+ * @param	v	the input vector.
+ * @return	the output vector.
+ */
+static inline simd_u8 simd_gamma(const simd_u8 v) {
+	simd_u8 p1, q1, p2, q2, p3, q3;
+
+	p1 = __builtin_shuffle(simd_P, v >> 4);
+	q1 = __builtin_shuffle(simd_Q, v & 0xF);
+	p2 = __builtin_shuffle(simd_P, ((p1 & 0x3) << 2) | (q1 & 0x3));   // {p1[1:0], q1[1:0]}
+	q2 = __builtin_shuffle(simd_Q, (p1 & 0xC) | (q1 >> 2));		     // {p1[3:2], q1[3:2]}
+	p3 = __builtin_shuffle(simd_P, (q2 & 0xC) | (p2 >> 2));		     // {q2[3:2], p2[3:2]}
+	q3 = __builtin_shuffle(simd_Q, ((q2 & 0x3) << 2) | (p2 & 0x3));   // {q2[1:0], p2[1:0]}
+	return (p3 << 4) | q3;
+}
+
+/**
+ * Multiplication by 2 over GF(2^8) of each byte, with the KHAZAD reduction polynomial
+ * x^8 + x^4 + x^3 + x^2 + 1 (as the "mult2" wire of poly_mult.v).
+ */
+static inline simd_u8 simd_xtime(const simd_u8 v) {
+	return (v << 1) ^ ((v >> 7) * 0x1D);
+}
+
+/**
+ * Linear diffusion layer theta, on each 8-byte block of the vector.
+ * Output byte j = sum over d of coef[d] * x[j^d], with coef = 1,3,4,5,6,8,B,7 (row 0 of theta.v).
+ *
+ * @param	v	the input vector.
+ * @return	the output vector.
+ */
+static inline simd_u8 simd_theta(const simd_u8 v) {
+	simd_u8 x1, x2, x3, x4, x5, x6, x7;
+
+	x1 = __builtin_shuffle(v, SIMD_XOR(1));
+	x2 = __builtin_shuffle(v, SIMD_XOR(2));
+	x3 = __builtin_shuffle(v, SIMD_XOR(3));
+	x4 = __builtin_shuffle(v, SIMD_XOR(4));
+	x5 = __builtin_shuffle(v, SIMD_XOR(5));
+	x6 = __builtin_shuffle(v, SIMD_XOR(6));
+	x7 = __builtin_shuffle(v, SIMD_XOR(7));
+
+	return v ^ x1 ^ x3 ^ x6 ^ x7 ^							// A0: coefficients with bit 0 (1,3,5,B,7)
+		simd_xtime(x1 ^ x4 ^ x6 ^ x7 ^						// A1: coefficients with bit 1 (3,6,B,7)
+		simd_xtime(x2 ^ x3 ^ x4 ^ x7 ^						// A2: coefficients with bit 2 (4,5,6,7)
+		simd_xtime(x5 ^ x6)));								// A3: coefficients with bit 3 (8,B)
+}
+
+/**
+ * Either encrypt or decrypt a buffer of data blocks, according to the key schedule.
+ *
+ * @param	input		the data blocks to be encrypted/decrypted.
+ * @param	output		the resulting data blocks (may be the same buffer as input).
+ * @param	blocks		number of data blocks.
+ * @param	roundKey	the key schedule to be used.
+ */
+static void simd_crypt(const u8 *input, u8 *output, const u32 blocks,
+					   const u32 roundKey[R + 1][2]) {
+	simd_u8 key[R + 1], w[SIMD_INTERLEAVE], v;
+	u8 tail[KHAZAD_SIMD_BYTES];
+	u32 i, n;
+	int r, k;
+
+	/*
+	 * broadcast each round key (big-endian) to all the blocks of a vector:
+	 */
+	for (r = 0; r <= R; r++)
+		for (k = 0; k < KHAZAD_SIMD_BYTES; k += BLOCKSIZEB) {
+			key[r][k    ] = (u8)(roundKey[r][0] >> 24);
+			key[r][k + 1] = (u8)(roundKey[r][0] >> 16);
+			key[r][k + 2] = (u8)(roundKey[r][0] >>  8);
+			key[r][k + 3] = (u8)(roundKey[r][0]      );
+			key[r][k + 4] = (u8)(roundKey[r][1] >> 24);
+			key[r][k + 5] = (u8)(roundKey[r][1] >> 16);
+			key[r][k + 6] = (u8)(roundKey[r][1] >>  8);
+			key[r][k + 7] = (u8)(roundKey[r][1]      );
+		}
+
+	/*
+	 * SIMD_INTERLEAVE independent vectors per round, to hide the shuffle latency:
+	 */
+	for (i = 0; i + SIMD_INTERLEAVE*SIMD_BLOCKS <= blocks; i += SIMD_INTERLEAVE*SIMD_BLOCKS) {
+		memcpy(w, input + BLOCKSIZEB*i, sizeof(w));
+		for (k = 0; k < SIMD_INTERLEAVE; k++)
+			w[k] ^= key[0];
+		for (r = 1; r < R; r++)
+			for (k = 0; k < SIMD_INTERLEAVE; k++)
+				w[k] = simd_theta(simd_gamma(w[k])) ^ key[r];
+		for (k = 0; k < SIMD_INTERLEAVE; k++)
+			w[k] = simd_gamma(w[k]) ^ key[R];  // last round
+		memcpy(output + BLOCKSIZEB*i, w, sizeof(w));
+	}
+
+	/*
+	 * remaining blocks, one vector at a time:
+	 */
+	for (; i < blocks; i += SIMD_BLOCKS) {
+		n = (blocks - i < SIMD_BLOCKS) ? blocks - i : SIMD_BLOCKS;
+		memset(tail, 0, KHAZAD_SIMD_BYTES);  // the last vector may be partial
+		memcpy(tail, input + BLOCKSIZEB*i, BLOCKSIZEB*n);
+		memcpy(&v, tail, KHAZAD_SIMD_BYTES);
+
+		v ^= key[0];
+		for (r = 1; r < R; r++)
+			v = simd_theta(simd_gamma(v)) ^ key[r];
+		v = simd_gamma(v) ^ key[R];  // last round
+
+		memcpy(tail, &v, KHAZAD_SIMD_BYTES);
+		memcpy(output + BLOCKSIZEB*i, tail, BLOCKSIZEB*n);
+	}
+}
+
+/**
+ * Encrypt a buffer of data blocks with the SIMD implementation (ECB).
+ *
+ * @param	structpointer	the expanded key (from NESSIEkeysetup).
+ * @param	plaintext		the data blocks to be encrypted.
+ * @param	ciphertext		the encrypted data blocks (may be the same buffer as plaintext).
+ * @param	blocks			number of data blocks.
+ */
+void NESSIEencrypt_simd(const struct NESSIEstruct * const structpointer,
+						const u8 * const plaintext,
+						      u8 * const ciphertext,
+						const u32 blocks) {
+	simd_crypt(plaintext, ciphertext, blocks, structpointer->roundKeyEnc);
+}
+
+/**
+ * Decrypt a buffer of data blocks with the SIMD implementation (ECB).
+ *
+ * @param	structpointer	the expanded key (from NESSIEkeysetup).
+ * @param	ciphertext		the data blocks to be decrypted.
+ * @param	plaintext		the decrypted data blocks (may be the same buffer as ciphertext).
+ * @param	blocks			number of data blocks.
+ */
+void NESSIEdecrypt_simd(const struct NESSIEstruct * const structpointer,
+						const u8 * const ciphertext,
+						      u8 * const plaintext,
+						const u32 blocks) {
+	simd_crypt(ciphertext, plaintext, blocks, structpointer->roundKeyDec);
+}
+
+#endif   /* KHAZAD_SIMD_H */
@@ -0,0 +1,241 @@
+#ifndef KHAZAD_UIO_H
+#define KHAZAD_UIO_H
+/********************************************************************************************************
+*********************************************************************************************************
+Zynq-7000 based Implementation of the KHAZAD Block Cipher
+Yossef Shitzer & Efraim Wasserman
+Jerusalem College of Technology - Lev Academic Center (JCT)
+Department of electrical and electronic engineering
+2018
+*********************************************************************************************************
+*********************************************************************************************************
+This file implements the Linux userspace backend of the hardware access layer ("khazad-hal.h"), so the PL
+driver runs under Linux (PetaLinux on the Zynq PS) next to other processes, without the standalone BSP:
+	registers - the AXI_GPIO window (ADDR0 .. ADDR4, or ADDR5 with HAL_SPLIT_DATA; UIO_AXI_SIZE bytes) and the page of the PS GPIO controller
+			(the EMIO ready flag, HAL_READY_PIN) are mapped into the process, from UIO devices (/dev/uioN) or
+			from /dev/mem (at their physical addresses), and accessed with plain volatile loads and stores.
+			The ready flag is read from the read-only DATA_RO register, so the kernel GPIO driver may keep the PS GPIO.
+	interrupt - in HAL_WAIT_HYBRID mode, the driver sleeps on the UIO device of done_IRQ (IRQ_F2P[0], with the
+			generic UIO driver): writing 1 to the device enables the interrupt, and a read returns when it fires.
+			The read waits at most UIO_TIMEOUT_MS (poll), so a missing interrupt costs a timeout, not a hang.
+	caller buffers - the data words are written from and read into the caller's buffers directly, with no copy
+			through a driver buffer and no system call per block: khazad_hal_crypt_blocks runs on any buffer
+			(in place too), e.g. a memory-mapped file.
+Test mode: a regular file of UIO_STANDIN_SIZE bytes may stand in for the device (the AXI_GPIO window, then the
+PS GPIO page), with a process that plays the PL on the file (see linux/khazad_uio.c). uio->standin_start is then
+called after every ctrl write (the start pulse of the PL latches the registers), and uio->irq_fd may be any
+descriptor with the read/write semantics of a UIO device. On the device, uio->standin_start is NULL.
+Requires KHAZAD_LINUX. On the 32-bit PS, define _FILE_OFFSET_BITS 64 before all the includes (the /dev/mem
+offsets are above 2 GB).
+Usage:
+	struct khazad_hal hal;
+	struct khazad_hal_uio uio;
+	if (khazad_hal_uio_open(&hal, &uio, "/dev/uio0", "/dev/mem", "/dev/uio0") != 0)
+		perror(...);
+	khazad_hal_set_wait(&hal, HAL_WAIT_HYBRID, HAL_SPIN_POLLS);
+	khazad_hal_crypt_blocks(&hal, &ctx, buffer, buffer, nblocks, op_mode, enc_dec);
+	khazad_hal_uio_close(&uio);
+*********************************************************************************************************
+*********************************************************************************************************/
+
+#ifndef KHAZAD_LINUX
+#error "khazad-uio.h requires KHAZAD_LINUX"
+#endif
+
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/mman.h>
+#define crypt  uio_unistd_crypt  // <unistd.h> declares crypt(), which conflicts with khazad-tweak32.h
+#include <unistd.h>
+#undef crypt
+#include "nessie_modified.h"
+#include "khazad-hal.h"
+
+// the AXI_GPIO window (AXI_GPIO_0 .. AXI_GPIO_4, and AXI_GPIO_5 with HAL_SPLIT_DATA, 64 KB each):
+#define UIO_AXI_BASE  ADDR0
+#ifdef HAL_SPLIT_DATA
+#define UIO_AXI_SIZE  (ADDR5 - ADDR0 + 0x10000)
+#else
+#define UIO_AXI_SIZE  (ADDR4 - ADDR0 + 0x10000)
+#endif
+// the PS GPIO controller, and the DATA_RO register of the EMIO bank of the ready flag (bank 2: pins 54..85):
+#define UIO_GPIO_BASE    0xE000A000
+#define UIO_GPIO_SIZE    0x1000
+#define UIO_READY_REG    0x68
+#define UIO_READY_BIT    (HAL_READY_PIN - 54)
+// the AXI_GPIO channel 1 direction register (TRI), of the bidirectional GPIO_4 (without HAL_SPLIT_DATA):
+#define UIO_GPIO_TRI     0x4
+// the size of a stand-in file (test mode):
+#define UIO_STANDIN_SIZE  (UIO_AXI_SIZE + UIO_GPIO_SIZE)
+
+// the longest sleep on the interrupt, in milliseconds (then the ready flag is polled again):
+#ifndef UIO_TIMEOUT_MS
+#define UIO_TIMEOUT_MS  100
+#endif
+
+struct khazad_hal_uio {
+	volatile u8 *axi;  // the AXI_GPIO window (ADDR0)
+	volatile u8 *gpio;  // the PS GPIO page
+	void *axi_map, *gpio_map;  // the mappings (gpio_map is NULL when the page is in axi_map)
+	size_t axi_size;  // UIO_AXI_SIZE, or UIO_STANDIN_SIZE
+	int axi_fd, gpio_fd;
+	int irq_fd;  // the UIO device of done_IRQ (-1: no interrupt, the ready flag is polled)
+	u32 interrupts;  // the interrupt count of the last wake-up (from the UIO device)
+	void (*standin_start)(struct khazad_hal_uio *uio);  // test mode only: the start pulse of the stand-in PL
+	void *standin;  // the stand-in state
+};
+
+static inline volatile u32 *hal_uio_reg(struct khazad_hal_uio *uio, const u32 addr) {
+	return (volatile u32 *)(uio->axi + (addr - UIO_AXI_BASE));
+}
+
+static u64 hal_uio_now(void) {
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (u64)t.tv_sec*1000000000u + t.tv_nsec;
+}
+
+static void hal_uio_out32(void *instance, const u32 addr, const u32 value) {
+	*hal_uio_reg((struct khazad_hal_uio *)instance, addr) = value;
+}
+
+static void hal_uio_out16(void *instance, const u32 addr, const u16 value) {
+	struct khazad_hal_uio *uio = (struct khazad_hal_uio *)instance;
+
+	*(volatile u16 *)hal_uio_reg(uio, addr) = value;
+	if (uio->standin_start && addr == ADDR0)
+		uio->standin_start(uio);
+}
+
+static u32 hal_uio_in32(void *instance, const u32 addr) {
+	return *hal_uio_reg((struct khazad_hal_uio *)instance, addr);
+}
+
+static void hal_uio_set_direction(void *instance, const u32 direction) {
+	*hal_uio_reg((struct khazad_hal_uio *)instance, ADDR4 + UIO_GPIO_TRI) = direction;
+}
+
+static u32 hal_uio_read_ready(void *instance) {
+	struct khazad_hal_uio *uio = (struct khazad_hal_uio *)instance;
+
+	if (uio->standin_start)
+		__sync_synchronize();  // a stand-in file is normal memory: the result is written before the flag
+	return (*(volatile u32 *)(uio->gpio + UIO_READY_REG) >> UIO_READY_BIT) & 1;
+}
+
+/*
+ * Sleep on the UIO device until done_IRQ: enable the interrupt, check the ready flag (the operation may have ended
+ * before), and read the interrupt count. A pending interrupt of an earlier operation only wakes the driver early.
+ */
+static u64 hal_uio_sleep(void *instance, const u16 ctrl) {
+	struct khazad_hal_uio *uio = (struct khazad_hal_uio *)instance;
+	struct pollfd irq;
+	u32 count = 1;
+	u64 start;
+
+	if (uio->irq_fd < 0 || write(uio->irq_fd, &count, sizeof(count)) != sizeof(count))
+		return 0;  // no interrupt: the ready flag is polled again
+	if (!((hal_uio_read_ready(uio) ^ ctrl) & 0x0001))
+		return 0;
+	start = hal_uio_now();
+	irq.fd = uio->irq_fd;
+	irq.events = POLLIN;
+	irq.revents = 0;
+	if (poll(&irq, 1, UIO_TIMEOUT_MS) > 0 && read(uio->irq_fd, &count, sizeof(count)) == sizeof(count))
+		uio->interrupts = count;
+	return hal_uio_now() - start;
+}
+
+static const struct khazad_hal_ops hal_uio_ops = {
+	hal_uio_out32, hal_uio_out16, hal_uio_in32, hal_uio_set_direction, hal_uio_read_ready,
+	hal_uio_sleep
+};
+
+/**
+ * Unmap the register windows and close the devices.
+ */
+void khazad_hal_uio_close(struct khazad_hal_uio *uio) {
+	if (uio->axi_map)
+		munmap(uio->axi_map, uio->axi_size);
+	if (uio->gpio_map)
+		munmap(uio->gpio_map, UIO_GPIO_SIZE);
+	if (uio->axi_fd >= 0)
+		close(uio->axi_fd);
+	if (uio->gpio_fd >= 0)
+		close(uio->gpio_fd);
+	if (uio->irq_fd >= 0)
+		close(uio->irq_fd);
+	uio->axi_map = uio->gpio_map = NULL;
+	uio->axi_fd = uio->gpio_fd = uio->irq_fd = -1;
+}
+
+/*
+ * Open a device and map a window: /dev/mem at the physical address, a UIO device (map 0) or a file from its start.
+ */
+static void *hal_uio_map(const char * const path, int * const fd, const off_t physical, const size_t size) {
+	const bool mem = (strcmp(path, "/dev/mem") == 0);
+	void *map;
+
+	*fd = open(path, O_RDWR | (mem ? O_SYNC : 0));  // O_SYNC: uncached device memory
+	if (*fd < 0)
+		return NULL;
+	map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, *fd, mem ? physical : 0);
+	return (map == MAP_FAILED) ? NULL : map;
+}
+
+/**
+ * Connect a HAL to the PL design under Linux. The PL design is not reset (see khazad_hal_reset).
+ *
+ * @param	axi		the device of the AXI_GPIO window: a UIO device (map 0), /dev/mem, or a stand-in file.
+ * @param	gpio	the device of the PS GPIO page: a UIO device (map 0), /dev/mem, or NULL when it is in the
+ * 					stand-in file axi (after the AXI_GPIO window).
+ * @param	irq		the UIO device of done_IRQ, or NULL to poll the ready flag only.
+ * @return	0, or -1 on failure (errno is set, and nothing is left open).
+ */
+int khazad_hal_uio_open(struct khazad_hal *hal, struct khazad_hal_uio *uio, const char * const axi,
+						const char * const gpio, const char * const irq) {
+	int error;
+
+	memset(uio, 0, sizeof(*uio));
+	uio->axi_fd = uio->gpio_fd = uio->irq_fd = -1;
+	uio->axi_size = gpio ? UIO_AXI_SIZE : UIO_STANDIN_SIZE;
+	uio->axi_map = hal_uio_map(axi, &uio->axi_fd, UIO_AXI_BASE, uio->axi_size);
+	if (!uio->axi_map)
+		goto fail;
+	uio->axi = (volatile u8 *)uio->axi_map;
+	if (gpio) {
+		uio->gpio_map = hal_uio_map(gpio, &uio->gpio_fd, UIO_GPIO_BASE, UIO_GPIO_SIZE);
+		if (!uio->gpio_map)
+			goto fail;
+		uio->gpio = (volatile u8 *)uio->gpio_map;
+	}
+	else
+		uio->gpio = uio->axi + UIO_AXI_SIZE;
+	if (irq) {
+		uio->irq_fd = open(irq, O_RDWR);
+		if (uio->irq_fd < 0)
+			goto fail;
+	}
+
+	hal->ops = &hal_uio_ops;
+	hal->instance = uio;
+	hal->ctrl = 0;
+	hal->key_loaded = 0;
+	hal->IV_loaded = 0;
+	khazad_hal_set_elision(hal, 1);
+	khazad_hal_set_wait(hal, HAL_WAIT_POLL, HAL_SPIN_POLLS);
+	khazad_hal_clear_stats(hal);
+	return 0;
+
+fail:
+	error = errno;
+	khazad_hal_uio_close(uio);
+	errno = error;
+	return -1;
+}
+
+#endif   /* KHAZAD_UIO_H */
@@ -0,0 +1,382 @@
+/********************************************************************************************************
+*********************************************************************************************************
+Zynq-7000 based Implementation of the KHAZAD Block Cipher
+Yossef Shitzer & Efraim Wasserman
+Jerusalem College of Technology - Lev Academic Center (JCT)
+Department of electrical and electronic engineering
+2018
+*********************************************************************************************************
+*********************************************************************************************************
+Linux file encryption tool: encrypts and decrypts files of any size in ECB, CBC or CTR mode.
+The input file is memory-mapped in windows of SEGMENT_BYTES (so files larger than the address space of
+the Zynq PS can be processed too), every window is processed into a page-aligned output buffer,
+and the buffer is written to the output file in one unbuffered write.
+ECB encryption/decryption, CBC decryption and CTR run on the thread pool ("khazad-pool.h");
+CBC encryption is sequential by nature, and runs on the calling thread (64-bit engine).
+File formats:
+	ECB - the ciphertext, with PKCS#7 padding (1 to 8 bytes of the padding length value).
+	CBC - the IV (one data block), then the ciphertext, with PKCS#7 padding.
+	CTR - the initial counter block (one data block), then the ciphertext, of the same length as the plaintext.
+The IV/counter block is random (/dev/urandom), unless it is given with -i.
+Usage: khazad_file -e|-d -m ecb|cbc|ctr -k <key, 32 hex figures> [-i <IV, 16 hex figures>] [-t threads] [-v] input output
+See README.txt for build instructions.
+*********************************************************************************************************
+*********************************************************************************************************/
+
+#define _FILE_OFFSET_BITS  64  // files larger than 2 GB on the 32-bit Zynq PS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "khazad-tweak32.h"
+#include "khazad-pool.h"
+
+// the input window and the output buffer size (a multiple of the page size and of BLOCKSIZEB):
+#ifndef SEGMENT_BYTES
+#define SEGMENT_BYTES  (8*1024*1024)
+#endif
+
+#define PAGE_BYTES  4096
+
+enum file_mode { MODE_ECB, MODE_CBC, MODE_CTR };
+
+struct file_job {
+	int encrypt;
+	enum file_mode mode;
+	struct NESSIEstruct subkeys;
+	struct khazad_pool pool;
+	u8 chain[BLOCKSIZEB];  // CBC: the last ciphertext block, CTR: the next counter block
+	FILE *out;
+	u8 *buffer;  // SEGMENT_BYTES + BLOCKSIZEB, page-aligned
+};
+
+static double seconds(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec*1e-9;
+}
+
+/*
+ * parse a hexadecimal string of exactly 2*len figures:
+ */
+static int parse_hex(const char *str, u8 *bytes, const u32 len)
+{
+	u32 i;
+	int hi = 0, lo;
+
+	if (strlen(str) != 2*len)
+		return -1;
+	for (i = 0; i < 2*len; i++)
+	{
+		char c = str[i];
+		int v = (c >= '0' && c <= '9') ? c - '0' :
+				(c >= 'a' && c <= 'f') ? c - 'a' + 10 :
+				(c >= 'A' && c <= 'F') ? c - 'A' + 10 : -1;
+		if (v < 0)
+			return -1;
+		if (i & 1)
+			lo = v, bytes[i/2] = (u8)((hi << 4) | lo);
+		else
+			hi = v;
+	}
+	return 0;
+}
+
+static int random_block(u8 *block)
+{
+	FILE *f = fopen("/dev/urandom", "rb");
+	size_t n;
+
+	if (f == NULL)
+		return -1;
+	n = fread(block, 1, BLOCKSIZEB, f);
+	fclose(f);
+	return (n == BLOCKSIZEB) ? 0 : -1;
+}
+
+/*
+ * map a window of the input file (any offset; the mapping itself starts at a page boundary):
+ */
+static const u8 *map_window(FILE *in, const u64 offset, const size_t length, void **base, size_t *mapped)
+{
+	u64 start = offset & ~(u64)(PAGE_BYTES - 1);
+
+	*mapped = (size_t)(offset - start) + length;
+	*base = mmap(NULL, *mapped, PROT_READ, MAP_SHARED, fileno(in), (off_t)start);
+	if (*base == MAP_FAILED)
+		return NULL;
+	// read-ahead hints, one call per advice (the advice values are not bit flags). They only tune the page
+	// cache, so their result is ignored: if the kernel rejects one, the window is still read correctly.
+	(void)madvise(*base, *mapped, MADV_SEQUENTIAL);
+	(void)madvise(*base, *mapped, MADV_WILLNEED);
+	return (const u8 *)*base + (offset - start);
+}
+
+static int write_out(struct file_job *job, const u8 *data, const size_t length)
+{
+	if (length && fwrite(data, 1, length, job->out) != length)
+	{
+		perror("write");
+		return -1;
+	}
+	return 0;
+}
+
+/*
+ * CBC encryption of whole data blocks, chained through job->chain:
+ */
+static void cbc_encrypt(struct file_job *job, const u8 *in, u8 *out, const u32 blocks)
+{
+	u32 i, j;
+
+	for (i = 0; i < blocks; i++, in += BLOCKSIZEB, out += BLOCKSIZEB)
+	{
+		for (j = 0; j < BLOCKSIZEB; j++)
+			out[j] = in[j] ^ job->chain[j];
+		NESSIEencrypt64(&job->subkeys, out, out);
+		memcpy(job->chain, out, BLOCKSIZEB);
+	}
+}
+
+/*
+ * process whole data blocks of one window, from the input window to the output buffer:
+ */
+static void process_blocks(struct file_job *job, const u8 *in, u8 *out, const u32 blocks)
+{
+	if (blocks == 0)
+		return;
+	switch (job->mode)
+	{
+	case MODE_ECB:
+		khazad_pool_ecb(&job->pool, &job->subkeys, job->encrypt ? KHAZAD_POOL_ENCRYPT : KHAZAD_POOL_DECRYPT,
+						in, out, blocks);
+		break;
+	case MODE_CBC:
+		if (job->encrypt)
+			cbc_encrypt(job, in, out, blocks);
+		else
+			khazad_pool_cbc_decrypt(&job->pool, &job->subkeys, job->chain, in, out, blocks);
+		break;
+	case MODE_CTR:
+		khazad_pool_ctr(&job->pool, &job->subkeys, job->chain, in, out, blocks);
+		break;
+	}
+}
+
+/*
+ * process one window; last = 1 for the last window of the file, where the padding is added or removed:
+ */
+static int process_window(struct file_job *job, const u8 *in, const size_t length, const int last)
+{
+	u32 blocks = (u32)(length / BLOCKSIZEB), residue = (u32)(length % BLOCKSIZEB), pad, i;
+	u8 *out = job->buffer;
+
+	process_blocks(job, in, out, blocks);
+	if (!last)
+		return write_out(job, out, length);
+
+	if (job->mode == MODE_CTR)  // a partial last block uses a part of the key stream block
+	{
+		if (residue)
+		{
+			memset(out + length, 0, BLOCKSIZEB - residue);
+			memcpy(out + BLOCKSIZEB*blocks, in + BLOCKSIZEB*blocks, residue);
+			NESSIEcrypt_CTR_bulk(&job->subkeys, job->chain, out + BLOCKSIZEB*blocks, out + BLOCKSIZEB*blocks, 1);
+		}
+		return write_out(job, out, length);
+	}
+
+	if (job->encrypt)  // PKCS#7 padding, a whole padding block when the length is a multiple of BLOCKSIZEB
+	{
+		pad = BLOCKSIZEB - residue;
+		if (residue)
+			memcpy(out + BLOCKSIZEB*blocks, in + BLOCKSIZEB*blocks, residue);
+		memset(out + BLOCKSIZEB*blocks + residue, (int)pad, pad);
+		if (job->mode == MODE_CBC)
+			cbc_encrypt(job, out + BLOCKSIZEB*blocks, out + BLOCKSIZEB*blocks, 1);
+		else
+			NESSIEencrypt_blocks(&job->subkeys, out + BLOCKSIZEB*blocks, out + BLOCKSIZEB*blocks, 1);
+		return write_out(job, out, length + pad);
+	}
+
+	// remove and check the padding:
+	pad = out[length - 1];
+	if (pad < 1 || pad > BLOCKSIZEB)
+		pad = 0;
+	for (i = 1; pad && i <= pad; i++)
+		if (out[length - i] != pad)
+			pad = 0;
+	if (pad == 0)
+	{
+		fprintf(stderr, "Invalid padding (wrong key, IV or mode?) \n");
+		return -1;
+	}
+	return write_out(job, out, length - pad);
+}
+
+static void usage(void)
+{
+	fprintf(stderr,
+		"Usage: khazad_file -e|-d -m ecb|cbc|ctr -k <key> [-i <IV>] [-t threads] [-v] input output \n"
+		"	-e / -d		encrypt / decrypt \n"
+		"	-m			mode of operation (default: cbc) \n"
+		"	-k			128-bit key, 32 hexadecimal figures \n"
+		"	-i			IV / initial counter block, 16 hexadecimal figures (encryption only; default: random) \n"
+		"	-t			number of threads (default: one thread per online core) \n"
+		"	-v			print the throughput \n");
+}
+
+int main(int argc, char *argv[])
+{
+	struct file_job job;
+	struct stat st;
+	FILE *in;
+	const char *input = NULL, *output = NULL;
+	u8 key[KEYSIZEB];
+	u64 offset, size;
+	size_t length, mapped = 0;
+	const u8 *window;
+	void *base;
+	u32 threads = 0;
+	int i, direction = -1, key_set = 0, iv_set = 0, verbose = 0, result = 0;
+	double start, elapsed;
+
+	memset(&job, 0, sizeof(job));
+	job.mode = MODE_CBC;
+	for (i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-e") || !strcmp(argv[i], "-d"))
+			direction = (argv[i][1] == 'e');
+		else if (!strcmp(argv[i], "-m") && i + 1 < argc)
+		{
+			i++;
+			if (!strcmp(argv[i], "ecb"))
+				job.mode = MODE_ECB;
+			else if (!strcmp(argv[i], "cbc"))
+				job.mode = MODE_CBC;
+			else if (!strcmp(argv[i], "ctr"))
+				job.mode = MODE_CTR;
+			else
+				direction = -2;
+		}
+		else if (!strcmp(argv[i], "-k") && i + 1 < argc)
+			key_set = (parse_hex(argv[++i], key, KEYSIZEB) == 0) ? 1 : -1;
+		else if (!strcmp(argv[i], "-i") && i + 1 < argc)
+			iv_set = (parse_hex(argv[++i], job.chain, BLOCKSIZEB) == 0) ? 1 : -1;
+		else if (!strcmp(argv[i], "-t") && i + 1 < argc)
+			threads = (u32)atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-v"))
+			verbose = 1;
+		else if (argv[i][0] != '-' && input == NULL)
+			input = argv[i];
+		else if (argv[i][0] != '-' && output == NULL)
+			output = argv[i];
+		else
+			direction = -2;
+	}
+	if (direction < 0 || key_set != 1 || iv_set < 0 || input == NULL || output == NULL)
+	{
+		usage();
+		return 2;
+	}
+	job.encrypt = direction;
+
+	in = fopen(input, "rb");
+	if (in == NULL || fstat(fileno(in), &st) != 0)
+	{
+		perror(input);
+		return 1;
+	}
+	size = (u64)st.st_size;
+	offset = 0;
+
+	// the IV / counter block header:
+	if (job.mode != MODE_ECB)
+	{
+		if (!job.encrypt)
+		{
+			if (size < BLOCKSIZEB || fread(job.chain, 1, BLOCKSIZEB, in) != BLOCKSIZEB)
+			{
+				fprintf(stderr, "%s: missing IV block \n", input);
+				fclose(in);
+				return 1;
+			}
+			offset = BLOCKSIZEB;
+		}
+		else if (!iv_set && random_block(job.chain) != 0)
+		{
+			fprintf(stderr, "Cannot read /dev/urandom \n");
+			fclose(in);
+			return 1;
+		}
+	}
+	if (!job.encrypt && job.mode != MODE_CTR && (size == offset || (size - offset) % BLOCKSIZEB))
+	{
+		fprintf(stderr, "%s: the ciphertext length is not a positive multiple of %d bytes \n", input, BLOCKSIZEB);
+		fclose(in);
+		return 1;
+	}
+
+	job.out = fopen(output, "wb");
+	if (job.out == NULL || posix_memalign((void **)&job.buffer, PAGE_BYTES, SEGMENT_BYTES + BLOCKSIZEB) != 0)
+	{
+		perror(output);
+		fclose(in);
+		return 1;
+	}
+	setvbuf(job.out, NULL, _IONBF, 0);  // the aligned buffer is written directly
+	if (khazad_pool_init(&job.pool, threads) != 0)
+	{
+		fprintf(stderr, "Thread creation failed \n");
+		fclose(in);
+		fclose(job.out);
+		remove(output);
+		return 1;
+	}
+	NESSIEkeysetup(key, &job.subkeys);
+
+	start = seconds();
+	if (job.mode != MODE_ECB && job.encrypt)
+		result = write_out(&job, job.chain, BLOCKSIZEB);
+
+	// the windows; every window but the last is SEGMENT_BYTES long (whole data blocks):
+	do {
+		length = (size - offset > SEGMENT_BYTES) ? SEGMENT_BYTES : (size_t)(size - offset);
+		window = NULL;
+		base = NULL;
+		if (length)
+		{
+			window = map_window(in, offset, length, &base, &mapped);
+			if (window == NULL)
+			{
+				perror("mmap");
+				result = -1;
+				break;
+			}
+		}
+		if (result == 0)
+			result = process_window(&job, window, length, offset + length == size);
+		if (base)
+			munmap(base, mapped);
+		offset += length;
+	} while (result == 0 && offset < size);
+
+	elapsed = seconds() - start;
+	if (verbose && result == 0)
+		fprintf(stderr, "%llu bytes in %.3f s: %.1f MB/s with %u threads \n", (unsigned long long)size,
+				elapsed, size / (1024.0*1024.0) / (elapsed > 0 ? elapsed : 1e-9), job.pool.threads);
+
+	khazad_pool_destroy(&job.pool);
+	free(job.buffer);
+	fclose(in);
+	if (fclose(job.out) != 0)
+		result = -1;
+	if (result != 0)
+		remove(output);  // no partial output
+	return result ? 1 : 0;
+}
@@ -0,0 +1,604 @@
+/********************************************************************************************************
+*********************************************************************************************************
+Zynq-7000 based Implementation of the KHAZAD Block Cipher
+Yossef Shitzer & Efraim Wasserman
+Jerusalem College of Technology - Lev Academic Center (JCT)
+Department of electrical and electronic engineering
+2018
+*********************************************************************************************************
+*********************************************************************************************************
+Linux regression test of the PL driver, on the model backends of the hardware access layer ("khazad-hal.h").
+For each mode (ECB/CBC, encryption/decryption) a message is processed the way HW_application does it:
+the key (and the IV, in CBC mode) with the first block, then only_data blocks.
+The results are compared to the software engine, and the bus transactions per block (AXI writes and reads,
+GPIO_4 direction changes, ready flag polls, WFI sleeps and PL clock cycles) are printed and compared to the
+expected counts of the driver, so any change of the driver bus cost is detected.
+The cycle model runs with both completion wait modes: polling, and spin-then-sleep (SPIN_POLLS polls).
+Then the asynchronous job queue ("khazad-queue.h", with a small ring) runs the encryption and decryption
+of each mode as one job sequence, and its results and bus writes are compared to the synchronous driver.
+Last, the multi-block call (khazad_hal_crypt_blocks) processes each message in place, in two calls (the CBC
+chain continues from the session context, and the key of the second call is elided), and its results, bus writes
+and PL clock cycles are checked, and the key reload elision is checked with single block operations of two keys.
+The hybrid HW+SW dispatcher ("khazad-hybrid.h") runs ECB, CTR and CBC decryption with fixed times (all the blocks
+in the PL, PL and software blocks together, and the software engine alone), in place, in two calls.
+The size-aware HW/SW selection ("khazad-autoselect.h") is calibrated on the cycle model with the real time
+(its table must match its measured times, and the key is sent once: the PL is timed with the key resident), then runs each mode with a fixed table (the PL from 3 blocks on),
+in requests of 1, 2, 3, ... blocks, so the CBC chain continues across the two paths.
+The authentication modes of the PL driver ("khazad-hal-auth.h", the bodies of Zynq_pmac and Zynq_ccm) are
+cross-checked with the software engines (khazad_pmac, khazad_ccm_encrypt and khazad_ccm_decrypt) for messages
+of 0 to BLOCKS data blocks in bytes, with the number of PL operations; forged tags and ciphertexts must be
+rejected (and the plaintext erased) by both, and both must reject a length above CCM_MAX_LENGTH.
+The expected counts are of the bidirectional version 2.0 PL design (the bitstream in hw/), or of the design
+with separate data-in and data-out registers when compiled with -DHAL_SPLIT_DATA.
+Usage: khazad_hal_test
+See README.txt for build instructions.
+*********************************************************************************************************
+*********************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "khazad-tweak32.h"
+#include "khazad-hal.h"
+#define QUEUE_JOBS  4  // smaller than the number of jobs, to test a full ring
+#include "khazad-queue.h"
+#include "khazad-hybrid.h"
+#include "khazad-autoselect.h"
+#include "khazad-hal-auth.h"
+
+#define MODES     4
+#define BLOCKS    16
+#define BACKENDS  3
+#define SPIN_POLLS  3  // polls before sleeping, in the spin-then-sleep test
+
+static const char *backend_name[BACKENDS] = {"Model", "Cycle model, polling", "Cycle model, spin-then-sleep"};
+
+static const char *mode_name[MODES] = {"ECB encryption", "ECB decryption", "CBC encryption", "CBC decryption"};
+
+// the expected bus transactions of one block: writes, reads, direction changes, polls, sleeps, cycles
+struct expected_cost {
+	u32 writes, reads, direction_changes, polls, sleeps;
+	u64 cycles;
+};
+
+// [backend][CBC][first block: new key (and IV), other blocks: only_data]
+// (cycle model with HAL_AXI_CYCLES = 16, HAL_POLL_CYCLES = 4 and HAL_IRQ_CYCLES = 40)
+static const struct expected_cost expected[BACKENDS][2][2] = {
+#ifndef HAL_SPLIT_DATA
+	{  // model
+		{{3, 2, 2, 1, 0, 0}, {7, 2, 2, 1, 0, 0}},  // ECB
+		{{3, 2, 2, 1, 0, 0}, {9, 2, 2, 1, 0, 0}}   // CBC
+	},
+	{  // cycle model, polling
+		{{3, 2, 2, 1, 0, 116}, {7, 2, 2, 3, 0, 188}},  // ECB
+		{{3, 2, 2, 1, 0, 116}, {9, 2, 2, 3, 0, 220}}   // CBC
+	},
+	{  // cycle model, spin-then-sleep
+		{{3, 2, 2, 1, 0, 116}, {7, 2, 2, 3, 0, 188}},  // ECB
+		{{3, 2, 2, 1, 0, 116}, {9, 2, 2, 3, 0, 220}}   // CBC
+	}
+#else
+	{  // model
+		{{3, 2, 0, 1, 0, 0}, {7, 2, 0, 1, 0, 0}},  // ECB
+		{{3, 2, 0, 1, 0, 0}, {9, 2, 0, 1, 0, 0}}   // CBC
+	},
+	{  // cycle model, polling
+		{{3, 2, 0, 3, 0, 92}, {7, 2, 0, 7, 0, 172}},  // ECB
+		{{3, 2, 0, 3, 0, 92}, {9, 2, 0, 7, 0, 204}}   // CBC
+	},
+	{  // cycle model, spin-then-sleep
+		{{3, 2, 0, 3, 0, 92}, {7, 2, 0, 4, 1, 214}},  // ECB
+		{{3, 2, 0, 3, 0, 92}, {9, 2, 0, 4, 1, 246}}   // CBC
+	}
+#endif
+};
+
+/*
+ * The software result of a mode, block by block (64-bit engine).
+ */
+static void reference_mode(const struct NESSIEstruct *subkeys, int mode, const u8 *IV, const u8 *in, u8 *out)
+{
+	u8 chain[BLOCKSIZEB], block[BLOCKSIZEB];
+	int i, j;
+
+	memcpy(chain, IV, BLOCKSIZEB);
+	for (i = 0; i < BLOCKS; i++)
+	{
+		const u8 *x = in + BLOCKSIZEB*i;
+		u8 *y = out + BLOCKSIZEB*i;
+
+		switch (mode)
+		{
+		case 0:
+			NESSIEencrypt64(subkeys, x, y);
+			break;
+		case 1:
+			NESSIEdecrypt64(subkeys, x, y);
+			break;
+		case 2:
+			for (j = 0; j < BLOCKSIZEB; j++)
+				block[j] = x[j] ^ chain[j];
+			NESSIEencrypt64(subkeys, block, y);
+			memcpy(chain, y, BLOCKSIZEB);
+			break;
+		default:
+			NESSIEdecrypt64(subkeys, x, block);
+			for (j = 0; j < BLOCKSIZEB; j++)
+				y[j] = block[j] ^ chain[j];
+			memcpy(chain, x, BLOCKSIZEB);
+			break;
+		}
+	}
+}
+
+static int check_cost(const char *name, const struct khazad_hal_stats *s, u32 blocks, const struct expected_cost *e)
+{
+	printf("  %-22s %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f \n", name, (double)s->writes/blocks, (double)s->reads/blocks,
+		   (double)s->direction_changes/blocks, (double)s->polls/blocks, (double)s->sleeps/blocks,
+		   (double)s->cycles/blocks);
+	if (s->blocks != blocks || s->writes != e->writes*blocks || s->reads != e->reads*blocks ||
+		s->direction_changes != e->direction_changes*blocks || s->polls != e->polls*blocks ||
+		s->sleeps != e->sleeps*blocks || s->cycles != e->cycles*blocks)
+	{
+		printf("  %s: bus transactions differ from the expected (%u, %u, %u, %u, %u, %llu per block)! \n", name,
+			   e->writes, e->reads, e->direction_changes, e->polls, e->sleeps, (unsigned long long)e->cycles);
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * Encrypt BLOCKS blocks and decrypt the results with the job queue, polling between the submissions.
+ */
+static int queue_test(int CBC, const u8 *in, const u8 *ref, u32 key1, u32 key2, u32 key3, u32 key4, u32 IV1, u32 IV2)
+{
+	u8 cipher[BLOCKS*BLOCKSIZEB], decrypted[BLOCKS*BLOCKSIZEB];
+	struct khazad_hal hal;
+	struct khazad_hal_model model;
+	struct khazad_queue queue;
+	struct khazad_job job;
+	u32 ticket = 0, writes;
+	int k;
+
+	khazad_hal_model_init(&hal, &model, 1);
+	khazad_queue_init(&queue, &hal);
+	job.key1 = key1; job.key2 = key2; job.key3 = key3; job.key4 = key4;
+	job.IV1 = IV1; job.IV2 = IV2;
+	job.op_mode = CBC;
+	for (k = 0; k < 2*BLOCKS; k++)
+	{
+		job.enc_dec = (k < BLOCKS);
+		job.text = job.enc_dec ? in + BLOCKSIZEB*k : cipher + BLOCKSIZEB*(k - BLOCKS);
+		job.result = job.enc_dec ? cipher + BLOCKSIZEB*k : decrypted + BLOCKSIZEB*(k - BLOCKS);
+		job.only_data = (k != 0);
+		job.first_block = (k % BLOCKS == 0);
+		job.new_IV = (k == 0);
+		ticket = khazad_queue_submit(&queue, &job);
+		khazad_queue_poll(&queue);
+	}
+	khazad_queue_wait(&queue, ticket);
+
+	// the synchronous driver writes: the key and IV once, 2 data writes and a ctrl write per block
+	writes = 4 + 2*CBC + 3*2*BLOCKS;
+	printf("%s job queue: %u jobs, %u writes, %u reads, %u polls \n", CBC ? "CBC" : "ECB", queue.completed,
+		   hal.stats.writes, hal.stats.reads, hal.stats.polls);
+	if (queue.completed != 2*BLOCKS || hal.stats.blocks != 2*BLOCKS || hal.stats.writes != writes ||
+		memcmp(cipher, ref, sizeof(cipher)) != 0 || memcmp(decrypted, in, sizeof(decrypted)) != 0)
+	{
+		printf("  job queue results or bus writes differ from the synchronous driver! \n");
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * Process the message of a mode in place with two multi-block calls, on the cycle model.
+ * The synchronous cost (the first block and BLOCKS - 1 only_data blocks, with polling) is given for comparison.
+ */
+static int blocks_test(const struct NESSIEstruct *subkeys, int mode, const u8 *key, const u8 *IV, const u8 *in)
+{
+	u8 buf[BLOCKS*BLOCKSIZEB], ref[BLOCKS*BLOCKSIZEB];
+	struct khazad_hal hal;
+	struct khazad_hal_model model;
+	struct khazad_hal_ctx ctx;
+	bool CBC = mode >= 2, enc = !(mode & 1);
+	const struct expected_cost *e = expected[1][CBC];
+	u64 cycles = e[1].cycles + (BLOCKS - 1)*e[0].cycles;
+	u32 writes;
+
+	khazad_hal_model_init(&hal, &model, 1);
+	khazad_hal_ctx_init(&ctx, key, CBC ? IV : NULL);
+	memcpy(buf, in, sizeof(buf));
+	khazad_hal_crypt_blocks(&hal, &ctx, buf, buf, BLOCKS/2, CBC, enc);
+	khazad_hal_crypt_blocks(&hal, &ctx, buf + BLOCKSIZEB*BLOCKS/2, buf + BLOCKSIZEB*BLOCKS/2, BLOCKS - BLOCKS/2, CBC, enc);
+
+	// the key once (elided in the second call), the IV (the chaining value) with the first block of each call,
+	// 2 data writes and a ctrl write per block
+	writes = 4 + 2*2*CBC + 3*BLOCKS;
+	reference_mode(subkeys, mode, IV, in, ref);
+	printf("%-15s blocks call: %u writes, %u reads, %llu cycles (synchronous: %llu) \n", mode_name[mode],
+		   hal.stats.writes, hal.stats.reads, (unsigned long long)hal.stats.cycles, (unsigned long long)cycles);
+	if (hal.stats.blocks != BLOCKS || hal.stats.writes != writes || hal.stats.keys != 1 || hal.stats.keys_elided != 1 ||
+		memcmp(buf, ref, sizeof(buf)) != 0)
+	{
+		printf("  multi-block results or bus writes differ from the synchronous driver! \n");
+		return 1;
+	}
+#ifdef HAL_SPLIT_DATA
+	// the next data block is sent while the PL runs, so the blocks calls cost less than the synchronous driver
+	// (even with the second IV):
+	if (hal.stats.cycles >= cycles)
+	{
+		printf("  the multi-block call is not faster than the synchronous driver! \n");
+		return 1;
+	}
+#endif
+	return 0;
+}
+
+/*
+ * Key operations (only_data = 0) with keys A, A, B, A, then A, A without elision: the second operation runs
+ * as only_data, and all the others send their key.
+ */
+static int elision_test(const u8 *in)
+{
+	static const u8 key[2][KEYSIZEB] = {{0}, {0x80}};
+	static const int order[6] = {0, 0, 1, 0, 0, 0};
+	struct NESSIEstruct subkeys;
+	struct khazad_hal hal;
+	struct khazad_hal_model model;
+	struct khazad_hal_ctx ctx[2];
+	u8 out[BLOCKSIZEB], ref[BLOCKSIZEB];
+	int k, errors = 0;
+
+	khazad_hal_model_init(&hal, &model, 0);
+	for (k = 0; k < 2; k++)
+		khazad_hal_ctx_init(&ctx[k], key[k], NULL);
+	for (k = 0; k < 6; k++)
+	{
+		const u32 *w = ctx[order[k]].key;
+
+		if (k == 4)
+			khazad_hal_set_elision(&hal, 0);
+		khazad_hal_crypt(&hal, in + BLOCKSIZEB*k, w[0], w[1], w[2], w[3], 0, 0, 0, 1, 0, 0, 0, out);
+		NESSIEkeysetup(key[order[k]], &subkeys);
+		NESSIEencrypt(&subkeys, in + BLOCKSIZEB*k, ref);
+		errors += (memcmp(out, ref, BLOCKSIZEB) != 0);
+	}
+	printf("key reload elision: %u key operations, %u elided, %u writes \n", hal.stats.keys, hal.stats.keys_elided,
+		   hal.stats.writes);
+	if (errors || hal.stats.keys != 5 || hal.stats.keys_elided != 1 || hal.stats.writes != 5*7 + 3)
+	{
+		printf("  key reload elision results or bus writes differ from the expected! \n");
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * The hybrid dispatcher with the times {hw_bus, hw_wait, sw_block} of setting, for each of its modes.
+ */
+static int hybrid_test(const struct NESSIEstruct *subkeys, const u8 *key, const u8 *IV, const u8 *in)
+{
+	static const char *name[4] = {"ECB encryption", "ECB decryption", "CTR", "CBC decryption"};
+	static const u32 setting[4][3] = {{0, 0, 0}, {2, 10, 5}, {2, 10, 30}, {10, 10, 5}};  // PL, 2:1, 1:3, SW
+	u8 buf[BLOCKS*BLOCKSIZEB], ref[BLOCKS*BLOCKSIZEB], chain[BLOCKSIZEB], block[BLOCKSIZEB];
+	struct khazad_hal hal;
+	struct khazad_hal_model model;
+	struct khazad_hal_ctx ctx;
+	struct khazad_hybrid hybrid;
+	u32 hw, sw;
+	int mode, m, errors = 0, i, j;
+
+	khazad_hal_model_init(&hal, &model, 0);
+	khazad_hal_ctx_init(&ctx, key, NULL);
+	khazad_hybrid_init(&hybrid, &hal, NULL);
+	for (mode = 0; mode < 4; mode++)
+	{
+		// the software result (CTR: the key stream E(IV + i) XOR the data):
+		if (mode == KHAZAD_HYBRID_CTR)
+			for (i = 0; i < BLOCKS; i++)
+			{
+				U64TO8_BIG(block, U8TO64_BIG(IV) + i);
+				NESSIEencrypt64(subkeys, block, block);
+				for (j = 0; j < BLOCKSIZEB; j++)
+					ref[BLOCKSIZEB*i + j] = in[BLOCKSIZEB*i + j] ^ block[j];
+			}
+		else
+			reference_mode(subkeys, mode == KHAZAD_HYBRID_CBC_DECRYPT ? 3 : mode, IV, in, ref);
+
+		printf("hybrid %-15s", name[mode]);
+		for (m = 0; m < 4; m++)
+		{
+			hybrid.hw_bus = setting[m][0];
+			hybrid.hw_wait = setting[m][1];
+			hybrid.sw_block = setting[m][2];
+			memcpy(buf, in, sizeof(buf));
+			memcpy(chain, IV, BLOCKSIZEB);
+			khazad_hybrid_crypt(&hybrid, subkeys, &ctx, mode, buf, buf, chain, BLOCKS/2);
+			hw = hybrid.hw_blocks;
+			sw = hybrid.sw_blocks;
+			khazad_hybrid_crypt(&hybrid, subkeys, &ctx, mode, buf + BLOCKSIZEB*BLOCKS/2, buf + BLOCKSIZEB*BLOCKS/2,
+								chain, BLOCKS - BLOCKS/2);
+			hw += hybrid.hw_blocks;
+			sw += hybrid.sw_blocks;
+			printf("  %2u PL + %2u SW", hw, sw);
+			if (memcmp(buf, ref, sizeof(buf)) != 0 || hw + sw != BLOCKS || (m == 0 && sw != 0) ||
+				((m == 1 || m == 2) && (hw == 0 || sw == 0)) || (m == 1 && sw < hw) || (m == 2 && sw > hw) ||
+				(m == 3 && hw != 0))
+			{
+				printf("\n  hybrid results or split differ from the expected! \n");
+				errors++;
+			}
+		}
+		printf("\n");
+	}
+	return errors;
+}
+
+/*
+ * The time source of the selection calibration, in nanoseconds.
+ */
+static u64 now_ns(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (u64)t.tv_sec*1000000000u + t.tv_nsec;
+}
+
+static int autoselect_test(const struct NESSIEstruct *subkeys, const u8 *key, const u8 *IV, const u8 *in)
+{
+	u8 buf[BLOCKS*BLOCKSIZEB], ref[BLOCKS*BLOCKSIZEB];
+	struct khazad_hal hal;
+	struct khazad_hal_model model;
+	struct khazad_hal_ctx ctx;
+	struct khazad_autoselect select;
+	u32 done, n, c, classes = 0;
+	int mode, errors = 0;
+
+	khazad_hal_model_init(&hal, &model, 1);
+	khazad_hal_ctx_init(&ctx, key, IV);
+	khazad_autoselect_init(&select, &hal, now_ns);
+	memcpy(buf, in, sizeof(buf));
+	khazad_hal_set_elision(&hal, 0);
+	khazad_hal_clear_stats(&hal);
+	khazad_autoselect_calibrate(&select, subkeys, &ctx, buf, BLOCKS);
+	// the PL is timed with the key resident, as the software engine with the expanded key:
+	if (hal.stats.keys != 1 || hal.elision)
+	{
+		printf("autoselect calibration sent the key %u times (1 expected), or changed the elision! \n", hal.stats.keys);
+		errors++;
+	}
+	khazad_hal_set_elision(&hal, 1);
+	while ((1u << classes) <= BLOCKS)
+		classes++;
+	if (select.classes != classes)
+	{
+		printf("autoselect calibrated %u size classes instead of %u! \n", select.classes, classes);
+		errors++;
+	}
+	printf("autoselect crossovers (blocks):");
+	for (mode = 0; mode < MODES; mode++)
+	{
+		printf("  %s %u", mode_name[mode], select.crossover[mode]);
+		for (c = 0; c < select.classes; c++)
+			if (select.use_hw[mode][c] != (select.hw_time[mode][c] < select.sw_time[mode][c]) ||
+				(select.crossover[mode] && (1u << c) >= select.crossover[mode] && !select.use_hw[mode][c]))
+			{
+				printf("\n  autoselect table differs from its measured times! \n");
+				errors++;
+			}
+	}
+	printf("\n");
+
+	// a fixed table: 1 and 2 blocks in software, 3 and more in the PL:
+	for (mode = 0; mode < MODES; mode++)
+		for (c = 0; c < select.classes; c++)
+			select.use_hw[mode][c] = (c >= 2);
+	for (mode = 0; mode < MODES; mode++)
+	{
+		reference_mode(subkeys, mode, IV, in, ref);
+		khazad_hal_ctx_init(&ctx, key, IV);
+		select.hw_requests = 0;
+		select.sw_requests = 0;
+		memcpy(buf, in, sizeof(buf));
+		for (done = 0, n = 1; done < BLOCKS; done += n, n++)
+		{
+			if (n > BLOCKS - done)
+				n = BLOCKS - done;
+			khazad_autoselect_crypt(&select, subkeys, &ctx, buf + BLOCKSIZEB*done, buf + BLOCKSIZEB*done, n,
+									mode >= 2, !(mode & 1));
+		}
+		printf("autoselect %-15s  %u PL requests, %u software requests \n", mode_name[mode],
+			   select.hw_requests, select.sw_requests);
+		// requests of 1, 2, 3, 4, 5 and 1 blocks:
+		if (memcmp(buf, ref, sizeof(buf)) != 0 || select.hw_requests != 3 || select.sw_requests != 3)
+		{
+			printf("  autoselect results or routing differ from the expected! \n");
+			errors++;
+		}
+	}
+	return errors;
+}
+
+/*
+ * Flip one bit of a CCM tag or ciphertext, decrypt by both engines, and check the rejection.
+ */
+static int forgery_test(const struct NESSIEstruct *subkeys, struct khazad_hal *hal, const u8 *key, const u8 *nonce,
+						u8 *cipher, u32 length, u8 *tag, u8 *bit)
+{
+	u8 buf[BLOCKS*BLOCKSIZEB];
+	int errors = 0, hw, sw;
+
+	*bit ^= 0x01;
+	memset(buf, 0xFF, length);
+	hw = khazad_hal_ccm(hal, key, nonce, cipher, length, 0, buf, tag);
+	if (hw != -1 || (length && (buf[0] != 0 || buf[length - 1] != 0)))
+		errors++;
+	memset(buf, 0xFF, length);
+	sw = khazad_ccm_decrypt(subkeys, nonce, cipher, buf, length, tag);
+	if (sw != -1 || (length && (buf[0] != 0 || buf[length - 1] != 0)))
+		errors++;
+	*bit ^= 0x01;
+	return errors;
+}
+
+static int auth_test(const struct NESSIEstruct *subkeys, const u8 *key, const u8 *in)
+{
+	static const u8 nonce[CCM_NONCEB] = {0x00, 0x01, 0x02, 0x03};
+	u8 hw_tag[CCM_TAGB], sw_tag[CCM_TAGB], hw_out[BLOCKS*BLOCKSIZEB], sw_out[BLOCKS*BLOCKSIZEB], buf[BLOCKS*BLOCKSIZEB];
+	struct khazad_hal hal;
+	struct khazad_hal_model model;
+	u32 length, blocks, n;
+	int errors = 0;
+
+	khazad_hal_model_init(&hal, &model, 0);
+	for (length = 0; length <= BLOCKS*BLOCKSIZEB; length++)
+	{
+		n = (length + BLOCKSIZEB - 1)/BLOCKSIZEB;
+
+		// PMAC: L = E(0), the blocks before the last one, and the tag:
+		khazad_hal_clear_stats(&hal);
+		khazad_hal_pmac(&hal, key, in, length, hw_tag);
+		khazad_pmac(subkeys, in, length, sw_tag);
+		blocks = hal.stats.blocks;
+		if (memcmp(hw_tag, sw_tag, BLOCKSIZEB) != 0 || blocks != ((n == 0) ? 2 : n + 1))
+		{
+			printf("  PMAC of %u bytes: the PL driver differs from the software engine (%u PL operations)! \n",
+				   length, blocks);
+			errors++;
+		}
+
+		// CCM encryption: B0 and A_1, then the CBC-MAC and the next counter block of every block:
+		khazad_hal_clear_stats(&hal);
+		if (khazad_hal_ccm(&hal, key, nonce, in, length, 1, hw_out, hw_tag) != 0 ||
+			khazad_ccm_encrypt(subkeys, nonce, in, sw_out, length, sw_tag) != 0 ||
+			memcmp(hw_out, sw_out, length) != 0 || memcmp(hw_tag, sw_tag, CCM_TAGB) != 0 ||
+			hal.stats.blocks != 2*n + 2)
+		{
+			printf("  CCM encryption of %u bytes: the PL driver differs from the software engine! \n", length);
+			errors++;
+		}
+
+		// CCM decryption, by each engine of the other's result:
+		if (khazad_hal_ccm(&hal, key, nonce, sw_out, length, 0, buf, sw_tag) != 0 || memcmp(buf, in, length) != 0 ||
+			khazad_ccm_decrypt(subkeys, nonce, hw_out, buf, length, hw_tag) != 0 || memcmp(buf, in, length) != 0)
+		{
+			printf("  CCM decryption of %u bytes: the message is not recovered! \n", length);
+			errors++;
+		}
+
+		// forgeries: a tag bit, and a bit of the last ciphertext byte:
+		if (forgery_test(subkeys, &hal, key, nonce, sw_out, length, sw_tag, &sw_tag[length % CCM_TAGB]) ||
+			(length && forgery_test(subkeys, &hal, key, nonce, sw_out, length, sw_tag, &sw_out[length - 1])))
+		{
+			printf("  CCM of %u bytes: a forged message is accepted, or not erased! \n", length);
+			errors++;
+		}
+	}
+
+	// a length above CCM_MAX_LENGTH is rejected before any block is processed:
+	khazad_hal_clear_stats(&hal);
+	if (khazad_hal_ccm(&hal, key, nonce, in, CCM_MAX_LENGTH + 1, 1, buf, hw_tag) != -1 ||
+		khazad_hal_ccm(&hal, key, nonce, in, CCM_MAX_LENGTH + 1, 0, buf, hw_tag) != -1 ||
+		khazad_ccm_encrypt(subkeys, nonce, in, buf, CCM_MAX_LENGTH + 1, sw_tag) != -1 ||
+		khazad_ccm_decrypt(subkeys, nonce, in, buf, CCM_MAX_LENGTH + 1, sw_tag) != -1 || hal.stats.blocks != 0)
+	{
+		printf("  CCM of more than CCM_MAX_LENGTH bytes is not rejected! \n");
+		errors++;
+	}
+
+	printf("PMAC and CCM of 0 to %u bytes: the PL driver %s the software engines \n", BLOCKS*BLOCKSIZEB,
+		   errors ? "differs from" : "matches");
+	return errors;
+}
+
+int main(void)
+{
+	static const u8 key[KEYSIZEB] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+									 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F};
+	static const u8 IV[BLOCKSIZEB] = {0xF0, 0xE1, 0xD2, 0xC3, 0xB4, 0xA5, 0x96, 0x87};
+	u8 in[BLOCKS*BLOCKSIZEB], out[BLOCKS*BLOCKSIZEB], ref[BLOCKS*BLOCKSIZEB];
+	u32 key1, key2, key3, key4, IV1, IV2;
+	struct NESSIEstruct subkeys;
+	struct khazad_hal hal;
+	struct khazad_hal_model model;
+	struct khazad_hal_stats first;
+	int backend, mode, i, errors = 0;
+	bool CBC, enc;
+
+	for (i = 0; i < BLOCKS*BLOCKSIZEB; i++)
+		in[i] = (u8)(i*7 + 3);
+	NESSIEkeysetup(key, &subkeys);
+	key1 = ((u32)key[0] << 24) ^ ((u32)key[1] << 16) ^ ((u32)key[2] << 8) ^ ((u32)key[3]);
+	key2 = ((u32)key[4] << 24) ^ ((u32)key[5] << 16) ^ ((u32)key[6] << 8) ^ ((u32)key[7]);
+	key3 = ((u32)key[8] << 24) ^ ((u32)key[9] << 16) ^ ((u32)key[10] << 8) ^ ((u32)key[11]);
+	key4 = ((u32)key[12] << 24) ^ ((u32)key[13] << 16) ^ ((u32)key[14] << 8) ^ ((u32)key[15]);
+	IV1 = ((u32)IV[0] << 24) ^ ((u32)IV[1] << 16) ^ ((u32)IV[2] << 8) ^ ((u32)IV[3]);
+	IV2 = ((u32)IV[4] << 24) ^ ((u32)IV[5] << 16) ^ ((u32)IV[6] << 8) ^ ((u32)IV[7]);
+
+	for (backend = 0; backend < BACKENDS; backend++)
+	{
+		printf("\n%s backend, per block: \n", backend_name[backend]);
+		printf("  %-22s   writes    reads  dir.chg    polls   sleeps   cycles \n", "");
+		for (mode = 0; mode < MODES; mode++)
+		{
+			CBC = mode >= 2;
+			enc = !(mode & 1);
+			khazad_hal_model_init(&hal, &model, backend != 0);
+			if (backend == 2)
+				khazad_hal_set_wait(&hal, HAL_WAIT_HYBRID, SPIN_POLLS);
+			khazad_hal_reset(&hal, 1);
+			khazad_hal_reset(&hal, 0);
+			khazad_hal_clear_stats(&hal);
+
+			printf("%s: \n", mode_name[mode]);
+			for (i = 0; i < BLOCKS; i++)
+			{
+				khazad_hal_crypt(&hal, in + BLOCKSIZEB*i, key1, key2, key3, key4, IV1, IV2, i != 0, enc, CBC,
+								 i == 0, i == 0, out + BLOCKSIZEB*i);
+				if (i == 0)
+				{
+					first = hal.stats;
+					khazad_hal_clear_stats(&hal);
+				}
+			}
+
+			reference_mode(&subkeys, mode, IV, in, ref);
+			if (memcmp(out, ref, sizeof(out)) != 0)
+			{
+				printf("  results mismatch the software engine! \n");
+				errors++;
+			}
+			errors += check_cost(CBC ? "first block (key, IV)" : "first block (key)", &first, 1,
+								 &expected[backend][CBC][1]);
+			errors += check_cost("only_data blocks", &hal.stats, BLOCKS - 1, &expected[backend][CBC][0]);
+		}
+	}
+
+	printf("\n");
+	for (mode = 0; mode < MODES; mode += 2)  // the encryption modes, and the decryption of their results
+	{
+		reference_mode(&subkeys, mode, IV, in, ref);
+		errors += queue_test(mode >= 2, in, ref, key1, key2, key3, key4, IV1, IV2);
+	}
+
+	printf("\n");
+	for (mode = 0; mode < MODES; mode++)
+		errors += blocks_test(&subkeys, mode, key, IV, in);
+	errors += elision_test(in);
+	printf("\n");
+	errors += hybrid_test(&subkeys, key, IV, in);
+	printf("\n");
+	errors += autoselect_test(&subkeys, key, IV, in);
+	printf("\n");
+	errors += auth_test(&subkeys, key, in);
+
+	if (errors)
+		printf("\n%d errors \n", errors);
+	else
+		printf("\nAll results match the software engine, and the bus transactions match the expected \n");
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,157 @@
+/********************************************************************************************************
+*********************************************************************************************************
+Zynq-7000 based Implementation of the KHAZAD Block Cipher
+Yossef Shitzer & Efraim Wasserman
+Jerusalem College of Technology - Lev Academic Center (JCT)
+Department of electrical and electronic engineering
+2018
+*********************************************************************************************************
+*********************************************************************************************************
+Linux benchmark of the multi-threaded bulk engine ("khazad-pool.h").
+For each mode (ECB encryption, ECB decryption, CTR, CBC decryption) the same buffer is processed
+with pools of 1 to N threads, the results are compared to the single-threaded functions,
+and the throughput and the speedup relative to 1 thread are printed.
+Usage: khazad_pool_bench [megabytes] [max threads]
+	   (defaults: 64 MB, one thread per online core)
+See README.txt for build instructions.
+*********************************************************************************************************
+*********************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "khazad-tweak32.h"
+#include "khazad-pool.h"
+
+#define MODES       4
+#define REPEATS     3  // the best of REPEATS runs is reported
+
+static const char *mode_name[MODES] = {"ECB encryption", "ECB decryption", "CTR", "CBC decryption"};
+
+static double seconds(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec*1e-9;
+}
+
+/*
+ * run one mode on the pool, and return the elapsed time:
+ */
+static double run_mode(struct khazad_pool *pool, const struct NESSIEstruct *subkeys, int mode,
+					   const u8 *in, u8 *out, u32 blocks)
+{
+	u8 counter[BLOCKSIZEB] = {0}, CBC_Xor[BLOCKSIZEB] = {0};
+	double start = seconds();
+
+	switch (mode)
+	{
+	case 0: khazad_pool_ecb(pool, subkeys, KHAZAD_POOL_ENCRYPT, in, out, blocks); break;
+	case 1: khazad_pool_ecb(pool, subkeys, KHAZAD_POOL_DECRYPT, in, out, blocks); break;
+	case 2: khazad_pool_ctr(pool, subkeys, counter, in, out, blocks); break;
+	case 3: khazad_pool_cbc_decrypt(pool, subkeys, CBC_Xor, in, out, blocks); break;
+	}
+	return seconds() - start;
+}
+
+/*
+ * the single-threaded result of one mode, for verification:
+ */
+static void reference_mode(const struct NESSIEstruct *subkeys, int mode, const u8 *in, u8 *out, u32 blocks)
+{
+	u8 counter[BLOCKSIZEB] = {0}, CBC_Xor[BLOCKSIZEB] = {0};
+
+	switch (mode)
+	{
+	case 0: NESSIEencrypt_blocks(subkeys, in, out, blocks); break;
+	case 1: NESSIEdecrypt_blocks(subkeys, in, out, blocks); break;
+	case 2: NESSIEcrypt_CTR_bulk(subkeys, counter, in, out, blocks); break;
+	case 3: NESSIEdecrypt_CBC_bulk(subkeys, in, CBC_Xor, out, blocks); break;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	struct NESSIEstruct subkeys;
+	struct khazad_pool pool;
+	u8 key[KEYSIZEB], *in, *out, *ref;
+	u32 megabytes = 64, max_threads = 0, blocks, threads, i;
+	double best, t, base[MODES];
+	int mode, r, errors = 0;
+
+	if (argc > 1)
+		megabytes = (u32)atoi(argv[1]);
+	if (argc > 2)
+		max_threads = (u32)atoi(argv[2]);
+	if (max_threads == 0)
+	{
+		int cores = get_nprocs();
+		max_threads = (cores > 0) ? (u32)cores : 1;
+	}
+	if (max_threads > KHAZAD_POOL_MAX_THREADS)
+		max_threads = KHAZAD_POOL_MAX_THREADS;
+	if (megabytes == 0)
+		megabytes = 1;
+
+	blocks = megabytes*(1024*1024/BLOCKSIZEB);
+	in = (u8 *)malloc((size_t)blocks*BLOCKSIZEB);
+	out = (u8 *)malloc((size_t)blocks*BLOCKSIZEB);
+	ref = (u8 *)malloc((size_t)blocks*BLOCKSIZEB);
+	if (in == NULL || out == NULL || ref == NULL)
+	{
+		printf("Memory allocation of %u MB failed \n", 3*megabytes);
+		return 1;
+	}
+
+	for (i = 0; i < KEYSIZEB; i++)
+		key[i] = (u8)(3*i + 1);
+	for (i = 0; i < blocks*BLOCKSIZEB; i++)
+		in[i] = (u8)(7*i + 1);
+	NESSIEkeysetup(key, &subkeys);
+
+	printf("KHAZAD thread pool benchmark: %u MB, 1 to %u threads, chunk of %u blocks \n\n",
+		   megabytes, max_threads, BULK_CHUNK_BLOCKS);
+	printf("%-16s %8s %12s %10s \n", "mode", "threads", "MB/s", "speedup");
+
+	for (mode = 0; mode < MODES; mode++)
+	{
+		reference_mode(&subkeys, mode, in, ref, blocks);
+		for (threads = 1; threads <= max_threads; threads++)
+		{
+			if (khazad_pool_init(&pool, threads) != 0)
+			{
+				printf("Thread creation failed (%u threads) \n", threads);
+				return 1;
+			}
+			best = 0;
+			for (r = 0; r < REPEATS; r++)
+			{
+				memset(out, 0, (size_t)blocks*BLOCKSIZEB);
+				t = run_mode(&pool, &subkeys, mode, in, out, blocks);
+				if (r == 0 || t < best)
+					best = t;
+			}
+			khazad_pool_destroy(&pool);
+
+			if (memcmp(out, ref, (size_t)blocks*BLOCKSIZEB) != 0)
+			{
+				printf("%s with %u threads: results mismatch! \n", mode_name[mode], threads);
+				errors++;
+			}
+			if (threads == 1)
+				base[mode] = best;
+			printf("%-16s %8u %12.1f %9.2fx \n", mode_name[mode], threads, megabytes/best, base[mode]/best);
+		}
+	}
+
+	free(in);
+	free(out);
+	free(ref);
+	if (errors)
+		printf("\n%d errors \n", errors);
+	else
+		printf("\nAll results match the single-threaded functions \n");
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,319 @@
+/********************************************************************************************************
+*********************************************************************************************************
+Zynq-7000 based Implementation of the KHAZAD Block Cipher
+Yossef Shitzer & Efraim Wasserman
+Jerusalem College of Technology - Lev Academic Center (JCT)
+Department of electrical and electronic engineering
+2018
+*********************************************************************************************************
+*********************************************************************************************************
+Linux userspace driver of the PL design ("khazad-uio.h"): runs the PL driver from a Linux process, through
+UIO devices or /dev/mem, and checks it. For each mode (ECB/CBC, encryption/decryption) a buffer of data blocks
+is processed in place by the multi-block call (khazad_hal_crypt_blocks, directly on the caller's buffer),
+the results are compared to the software engine, and the time and the bus transactions per block are printed,
+with polling, and with interrupt sleeps (spin-then-sleep) when the done_IRQ device is given.
+Test mode (-s file): the device is replaced by a stand-in file of UIO_STANDIN_SIZE bytes, mapped by the driver
+like the device, and a child process plays the PL on the same file with the model of the PL design
+("khazad-hal.h"): the start pulse latches the registers (uio->standin_start), the child runs the operation,
+writes the result and the ready flag STANDIN_DELAY_US later, and fires done_IRQ through a socket with the
+read/write semantics of a UIO device. So the whole Linux driver path runs on any Linux machine.
+Usage: khazad_uio [-a <AXI_GPIO device>] [-g <PS GPIO device>] [-i <done_IRQ UIO device>] [-n blocks]
+       khazad_uio -s <stand-in file> [-n blocks]
+The default devices are /dev/mem (-a, -g), and no interrupt.
+See README.txt for build instructions.
+*********************************************************************************************************
+*********************************************************************************************************/
+
+#define _FILE_OFFSET_BITS  64  // the /dev/mem offsets above 2 GB, on the 32-bit Zynq PS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include "khazad-tweak32.h"
+#include "khazad-uio.h"
+
+#define MODES  4
+#define DEFAULT_BLOCKS  256
+#define SPIN_POLLS  4  // polls before sleeping, with interrupts
+
+// the time from the start pulse of the stand-in PL to its ready flag, in microseconds:
+#ifndef STANDIN_DELAY_US
+#define STANDIN_DELAY_US  20
+#endif
+
+static const char *mode_name[MODES] = {"ECB encryption", "ECB decryption", "CBC encryption", "CBC decryption"};
+
+// the stand-in PL: the registers latched by the start pulse, shared by the driver and the PL process:
+struct standin {
+	volatile u32 posted;  // start pulses of the driver
+	volatile u32 taken;  // start pulses run by the PL process
+	volatile u32 quit;
+	u32 key[4], IV[2], d_in[2], direction;
+	u16 ctrl;
+};
+
+static void usage(void)
+{
+	fprintf(stderr, "Usage: khazad_uio [-a <AXI_GPIO device>] [-g <PS GPIO device>] [-i <done_IRQ UIO device>] [-n blocks] \n"
+					"       khazad_uio -s <stand-in file> [-n blocks] \n"
+					"  -a  the AXI_GPIO window: /dev/mem (default) or a UIO device \n"
+					"  -g  the PS GPIO page (the EMIO ready flag): /dev/mem (default) or a UIO device \n"
+					"  -i  the UIO device of done_IRQ, for the interrupt sleeps (default: polling only) \n"
+					"  -s  test mode: a stand-in file for the device, with a model of the PL in a child process \n"
+					"  -n  number of data blocks per mode (default %u) \n", DEFAULT_BLOCKS);
+}
+
+/*
+ * The start pulse (called by the driver after every ctrl write): latch the registers for the PL process.
+ */
+static void standin_start(struct khazad_hal_uio *uio)
+{
+	struct standin *s = (struct standin *)uio->standin;
+	int i;
+
+	while (s->taken != s->posted)  // the PL runs one start pulse at a time (RST, then a start)
+		sched_yield();
+	for (i = 0; i < 4; i++)
+		s->key[i] = *hal_uio_reg(uio, (i < 2 ? ADDR1 : ADDR2) + (i & 1)*ADDR_offset);
+	s->IV[0] = *hal_uio_reg(uio, ADDR3);
+	s->IV[1] = *hal_uio_reg(uio, ADDR3 + ADDR_offset);
+	s->d_in[0] = *hal_uio_reg(uio, ADDR4);
+	s->d_in[1] = *hal_uio_reg(uio, ADDR4 + ADDR_offset);
+	s->direction = *hal_uio_reg(uio, ADDR4 + UIO_GPIO_TRI);
+	s->ctrl = *(volatile u16 *)hal_uio_reg(uio, ADDR0);
+	__sync_synchronize();
+	s->posted++;
+}
+
+/*
+ * The PL process: run the latched start pulses on the model, and write the results, the ready flag and done_IRQ
+ * into the stand-in file. The interrupt fires once after each enable (a write to the socket), like a UIO device.
+ */
+static void standin_PL(struct khazad_hal_uio *uio, struct standin *s, const int irq)
+{
+	struct khazad_hal hal;
+	struct khazad_hal_model model;
+	u32 interrupts = 0, enable;
+	u8 ready = 0;
+	bool enabled = 0;
+	int i;
+
+	khazad_hal_model_init(&hal, &model, 0);
+	while (!s->quit)
+	{
+		if (s->taken == s->posted)
+		{
+			sched_yield();
+			continue;
+		}
+		__sync_synchronize();
+		for (i = 0; i < 4; i++)
+			hal_model_out32(&model, (i < 2 ? ADDR1 : ADDR2) + (i & 1)*ADDR_offset, s->key[i]);
+		hal_model_out32(&model, ADDR3, s->IV[0]);
+		hal_model_out32(&model, ADDR3 + ADDR_offset, s->IV[1]);
+		hal_model_out32(&model, ADDR4, s->d_in[0]);
+		hal_model_out32(&model, ADDR4 + ADDR_offset, s->d_in[1]);
+		hal_model_set_direction(&model, s->direction);
+		hal_model_out16(&model, ADDR0, s->ctrl);  // the operation ends at once in the model
+		s->taken++;
+		if (model.ctrl_to_PS == ready)
+			continue;  // no operation has ended (RST = 0 after RST, or a start while busy)
+
+		if (!(s->ctrl & 0x0020))
+			usleep(STANDIN_DELAY_US);
+#ifdef HAL_SPLIT_DATA
+		*hal_uio_reg(uio, ADDR5) = hal_model_in32(&model, ADDR5);
+		*hal_uio_reg(uio, ADDR5 + ADDR_offset) = hal_model_in32(&model, ADDR5 + ADDR_offset);
+#else
+		*hal_uio_reg(uio, ADDR4) = hal_model_in32(&model, ADDR5);
+		*hal_uio_reg(uio, ADDR4 + ADDR_offset) = hal_model_in32(&model, ADDR5 + ADDR_offset);
+#endif
+		__sync_synchronize();
+		ready = model.ctrl_to_PS;
+		*(volatile u32 *)(uio->gpio + UIO_READY_REG) = (u32)ready << UIO_READY_BIT;
+		__sync_synchronize();
+
+		// done_IRQ, if the driver has enabled it (before the ready flag was written, or it has seen the flag):
+		while (recv(irq, &enable, sizeof(enable), MSG_DONTWAIT) == sizeof(enable))
+			enabled = 1;
+		if (enabled && !(s->ctrl & 0x0020))
+		{
+			interrupts++;
+			send(irq, &interrupts, sizeof(interrupts), 0);
+			enabled = 0;
+		}
+	}
+}
+
+/*
+ * The software result of a mode (64-bit engine).
+ */
+static void reference_mode(const struct NESSIEstruct *subkeys, const int mode, const u8 *IV, const u8 *in, u8 *out,
+						   const u32 blocks)
+{
+	u8 chain[BLOCKSIZEB];
+	u32 i;
+	int j;
+
+	memcpy(chain, IV, BLOCKSIZEB);
+	if (mode == 0)
+		NESSIEencrypt_blocks(subkeys, in, out, blocks);
+	else if (mode == 1)
+		NESSIEdecrypt_blocks(subkeys, in, out, blocks);
+	else if (mode == 2)
+		for (i = 0; i < blocks; i++)
+		{
+			for (j = 0; j < BLOCKSIZEB; j++)
+				chain[j] ^= in[BLOCKSIZEB*i + j];
+			NESSIEencrypt64(subkeys, chain, chain);
+			memcpy(out + BLOCKSIZEB*i, chain, BLOCKSIZEB);
+		}
+	else
+		NESSIEdecrypt_CBC_blocks(subkeys, in, chain, out, blocks);
+}
+
+int main(int argc, char *argv[])
+{
+	static const u8 key[KEYSIZEB] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+									 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F};
+	static const u8 IV[BLOCKSIZEB] = {0xF0, 0xE1, 0xD2, 0xC3, 0xB4, 0xA5, 0x96, 0x87};
+	const char *axi = "/dev/mem", *gpio = "/dev/mem", *irq = NULL, *standin_file = NULL;
+	struct khazad_hal hal;
+	struct khazad_hal_uio uio;
+	struct khazad_hal_ctx ctx;
+	struct NESSIEstruct subkeys;
+	struct standin *standin = NULL;
+	pid_t PL = -1;
+	int sockets[2], fd, i, mode, wait, waits, errors = 0;
+	u32 blocks = DEFAULT_BLOCKS;
+	u8 *in, *buf, *ref;
+	u64 start, elapsed;
+
+	for (i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-a") && i + 1 < argc)
+			axi = argv[++i];
+		else if (!strcmp(argv[i], "-g") && i + 1 < argc)
+			gpio = argv[++i];
+		else if (!strcmp(argv[i], "-i") && i + 1 < argc)
+			irq = argv[++i];
+		else if (!strcmp(argv[i], "-s") && i + 1 < argc)
+			standin_file = argv[++i];
+		else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+			blocks = (u32)atoi(argv[++i]);
+		else
+			blocks = 0;
+	}
+	if (blocks == 0)
+	{
+		usage();
+		return 2;
+	}
+
+	if (standin_file)
+	{
+		// test mode: a zeroed stand-in file (the reset state), the PL process, and the done_IRQ socket:
+		fd = open(standin_file, O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if (fd < 0 || ftruncate(fd, UIO_STANDIN_SIZE) != 0)
+		{
+			perror(standin_file);
+			return 1;
+		}
+		close(fd);
+		standin = mmap(NULL, sizeof(*standin), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+		if (standin == MAP_FAILED || socketpair(AF_UNIX, SOCK_DGRAM, 0, sockets) != 0)
+		{
+			perror("stand-in");
+			return 1;
+		}
+		memset(standin, 0, sizeof(*standin));
+		axi = standin_file;
+		gpio = NULL;
+		irq = NULL;
+	}
+	if (khazad_hal_uio_open(&hal, &uio, axi, gpio, irq) != 0)
+	{
+		perror(axi);
+		return 1;
+	}
+	if (standin_file)
+	{
+		uio.standin_start = standin_start;
+		uio.standin = standin;
+		PL = fork();
+		if (PL < 0)
+		{
+			perror("fork");
+			return 1;
+		}
+		if (PL == 0)
+		{
+			close(sockets[0]);
+			standin_PL(&uio, standin, sockets[1]);
+			_exit(0);
+		}
+		close(sockets[1]);
+		uio.irq_fd = sockets[0];
+		printf("Test mode: stand-in file %s, the PL in process %d (ready %u us after the start) \n",
+			   standin_file, (int)PL, STANDIN_DELAY_US);
+	}
+
+	in = malloc(3*(size_t)blocks*BLOCKSIZEB);
+	if (in == NULL)
+	{
+		perror("malloc");
+		return 1;
+	}
+	buf = in + (size_t)blocks*BLOCKSIZEB;
+	ref = buf + (size_t)blocks*BLOCKSIZEB;
+	for (i = 0; i < (int)(blocks*BLOCKSIZEB); i++)
+		in[i] = (u8)(i*7 + 3);
+	NESSIEkeysetup(key, &subkeys);
+
+	// the PL design reset:
+	khazad_hal_reset(&hal, 1);
+	usleep(1000);
+	khazad_hal_reset(&hal, 0);
+
+	waits = (uio.irq_fd >= 0) ? 2 : 1;
+	printf("%u data blocks per mode, in place, per block: \n", blocks);
+	printf("  %-15s %-16s %10s %8s %8s %8s %8s \n", "", "wait", "ns", "writes", "reads", "polls", "sleeps");
+	for (wait = 0; wait < waits; wait++)
+	{
+		khazad_hal_set_wait(&hal, wait ? HAL_WAIT_HYBRID : HAL_WAIT_POLL, SPIN_POLLS);
+		for (mode = 0; mode < MODES; mode++)
+		{
+			reference_mode(&subkeys, mode, IV, in, ref, blocks);
+			memcpy(buf, in, (size_t)blocks*BLOCKSIZEB);
+			khazad_hal_ctx_init(&ctx, key, IV);
+			khazad_hal_clear_stats(&hal);
+			start = hal_uio_now();
+			khazad_hal_crypt_blocks(&hal, &ctx, buf, buf, blocks, mode >= 2, !(mode & 1));
+			elapsed = hal_uio_now() - start;
+			printf("  %-15s %-16s %10.0f %8.2f %8.2f %8.2f %8.2f \n", mode_name[mode],
+				   wait ? "spin-then-sleep" : "polling", (double)elapsed/blocks, (double)hal.stats.writes/blocks,
+				   (double)hal.stats.reads/blocks, (double)hal.stats.polls/blocks, (double)hal.stats.sleeps/blocks);
+			if (memcmp(buf, ref, (size_t)blocks*BLOCKSIZEB) != 0 || hal.stats.blocks != blocks)
+			{
+				printf("  results mismatch the software engine! \n");
+				errors++;
+			}
+		}
+	}
+
+	if (PL > 0)
+	{
+		standin->quit = 1;
+		waitpid(PL, NULL, 0);
+	}
+	khazad_hal_uio_close(&uio);
+	free(in);
+	if (errors)
+		printf("\n%d errors \n", errors);
+	else
+		printf("\nAll results match the software engine \n");
+	return errors ? 1 : 0;
+}
@@ -38,6 +38,9 @@ int main()
   xil_printf("AXI_GPIO2 address = 0x%x \n\r", ADDR2);
   xil_printf("AXI_GPIO3 address = 0x%x \n\r", ADDR3);
   xil_printf("AXI_GPIO4 address = 0x%x \n\r", ADDR4);
+#ifdef HAL_SPLIT_DATA
+  xil_printf("AXI_GPIO5 address = 0x%x \n\r", ADDR5);
+#endif
   xil_printf("AXI_GPIO address offset = 0x%08x \n\r", ADDR_offset);
 
   // PL design initialization:
@@ -49,11 +52,10 @@ int main()
 	 bit 1 - first_block: flag for the CBC mode. 					1: first data block. 0: not first data block.
 	 bit 0 - bistable start/ready semaphore flag. To run an operation this bit must not be equal to a matching flag in the PL. */
   XGpioPs_WritePin(&my_Gpio, 47, 0); // turn off the PS-ready indicator LED
-  ctrl = 0x0020; // reset=1
-  Xil_Out16(ADDR0,ctrl); // send from PS to FPGA via AXI interface
+  khazad_hal_reset(&PL_hal, 1); // reset=1, send from PS to FPGA via AXI interface (ctrl is PL_hal.ctrl)
   usleep(50000);
-  ctrl = 0x0000; // reset=0
-  Xil_Out16(ADDR0,ctrl);
+  khazad_hal_reset(&PL_hal, 0); // reset=0
+  autoselect_calibration(); // HW/SW selection table of Zynq_crypt_auto
   XGpioPs_WritePin(&my_Gpio, 47, 1); // turn on the LED
 
   xil_printf("*************************************************************** \n\r");
@@ -71,6 +73,10 @@ int main()
 	  xil_printf("--6-- \t CBC-MAC generator \n\r");
 	  xil_printf("--7-- \t CSPRNG: Cryptographically Secure Pseudo-Random Number Generator \n\r");
 	  xil_printf("--8-- \t About \n\r");
+	  xil_printf("--b-- \t Software benchmark \n\r");
+	  xil_printf("--c-- \t Hardware completion wait modes report \n\r");
+	  xil_printf("--h-- \t Hybrid hardware + software report \n\r");
+	  xil_printf("--a-- \t Hardware/software auto-selection table \n\r");
 	  // xil_printf("--9-- \t Performance measurement \n\r"); - testing mode only
 	  xil_printf("--0-- \t Exit \n\r");
 	  xil_printf("To reset the FPGA design, you may press the MicroZed user button at any time. \n");
@@ -102,6 +108,22 @@ int main()
 	  case '8':
 		  about();
 		  break;
+	  case 'b':
+	  case 'B':
+		  SW_benchmark();
+		  break;
+	  case 'c':
+	  case 'C':
+		  completion_report();
+		  break;
+	  case 'h':
+	  case 'H':
+		  hybrid_report();
+		  break;
+	  case 'a':
+	  case 'A':
+		  autoselect_report();
+		  break;
 	 /* case '9':
 		  performance_measurement();
 		  break; */
@@ -12,13 +12,23 @@ Department of electrical and electronic engineering
 This file is essentially the original reference code header file "nessie.h", 
 slightly modified for data type compatibility with xilinx libraries to avoid conflict definitions.
 "xil_types.h" have been included in this file, and a few definitions have been commented.
+When KHAZAD_LINUX is defined (host builds), the same types are taken from <stdint.h> instead.
 The original file is available at: 
 https://www.cosic.esat.kuleuven.be/nessie/tweaks.html
 *********************************************************************************************************
 *********************************************************************************************************/
 
 #include <limits.h>
+#ifdef KHAZAD_LINUX
+/* Linux host build, without the xilinx libraries: */
+#include <stdint.h>
+typedef uint32_t u32;
+typedef int32_t s32;
+typedef uint64_t u64;
+typedef int64_t s64;
+#else
 #include "xil_types.h" // for data type compatibility
+#endif
 
 /* Definition of minimum-width integer types
  * 
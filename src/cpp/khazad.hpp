@@ -0,0 +1,268 @@
+#ifndef KHAZAD_HPP
+#define KHAZAD_HPP
+/********************************************************************************************************
+*********************************************************************************************************
+Zynq-7000 based Implementation of the KHAZAD Block Cipher
+Yossef Shitzer & Efraim Wasserman
+Jerusalem College of Technology - Lev Academic Center (JCT)
+Department of electrical and electronic engineering
+2018
+*********************************************************************************************************
+*********************************************************************************************************
+This file is a header-only C++ (C++14) implementation of KHAZAD.
+All the tables are generated at compile time (constexpr), from the same definitions as the hardware:
+	S-box - three layers of the 4-bit P and Q mini-boxes (S_box.v, P_mini_box.v, Q_mini_box.v).
+	theta - the dyadic matrix H, row 0 = 1,3,4,5,6,8,B,7 (theta.v), H[i][j] = H[0][i^j],
+			with multiplication over GF(2^8) modulo x^8 + x^4 + x^3 + x^2 + 1 (poly_mult.v).
+	round constants - c^r = S[8r], ..., S[8r+7], as c[R+1][2] of the reference code.
+The engine is a class template on the direction and the number of rounds, so every instantiation
+has its own round keys (the decryption round keys are prepared by the constructor), fully unrolled rounds,
+and a last round that reads the byte S-box directly, with constant shifts instead of masks.
+The results are identical to the reference code ("khazad-tweak32.h") for 8 rounds.
+Usage:
+	khazad::Encryptor enc(key);			// key: 16 bytes
+	enc.process(plaintext, ciphertext);	// one 8-byte block
+	enc.process(in, out, blocks);		// a buffer of blocks (ECB)
+	khazad::Decryptor dec(key);
+	dec.process(ciphertext, plaintext);
+*********************************************************************************************************
+*********************************************************************************************************/
+
+#include <cstddef>
+#include <cstdint>
+
+namespace khazad {
+
+enum class Direction { Encrypt, Decrypt };
+
+constexpr std::size_t KEY_BYTES = 16;
+constexpr std::size_t BLOCK_BYTES = 8;
+
+namespace detail {
+
+// P and Q mini-boxes, as the truth tables of P_mini_box.v and Q_mini_box.v:
+struct MiniBoxes {
+	std::uint8_t P[16];
+	std::uint8_t Q[16];
+};
+constexpr MiniBoxes mini = {
+	{0x3, 0xF, 0xE, 0x0, 0x5, 0x4, 0xB, 0xC, 0xD, 0xA, 0x9, 0x6, 0x7, 0x8, 0x2, 0x1},
+	{0x9, 0xE, 0x5, 0x6, 0xA, 0x2, 0x3, 0xC, 0xF, 0x0, 0x4, 0xD, 0x7, 0xB, 0x1, 0x8}
+};
+
+// row 0 of the matrix H (theta.v):
+constexpr std::uint8_t H0[8] = {0x1, 0x3, 0x4, 0x5, 0x6, 0x8, 0xB, 0x7};
+
+// the S-box, with the same wiring as S_box.v:
+constexpr std::uint8_t sbox(std::uint8_t x) {
+	std::uint8_t p1 = mini.P[x >> 4], q1 = mini.Q[x & 0xF];
+	std::uint8_t p2 = mini.P[((p1 & 0x3) << 2) | (q1 & 0x3)];  // {p1[1:0], q1[1:0]}
+	std::uint8_t q2 = mini.Q[(p1 & 0xC) | (q1 >> 2)];          // {p1[3:2], q1[3:2]}
+	std::uint8_t p3 = mini.P[(q2 & 0xC) | (p2 >> 2)];          // {q2[3:2], p2[3:2]}
+	std::uint8_t q3 = mini.Q[((q2 & 0x3) << 2) | (p2 & 0x3)];  // {q2[1:0], p2[1:0]}
+	return (std::uint8_t)((p3 << 4) | q3);
+}
+
+// multiplication over GF(2^8) with the KHAZAD reduction polynomial (0x11D):
+constexpr std::uint8_t gf_mul(std::uint8_t a, std::uint8_t b) {
+	std::uint8_t result = 0;
+	while (b) {
+		if (b & 1)
+			result ^= a;
+		a = (std::uint8_t)((a << 1) ^ ((a & 0x80) ? 0x1D : 0));
+		b >>= 1;
+	}
+	return result;
+}
+
+struct Tables {
+	std::uint8_t S[256];  // the S-box, for the last round and the round constants
+	std::uint64_t T[8][256];  // T[i][x] = S[x] * row i of H, byte 0 is the most significant
+};
+
+constexpr Tables make_tables() {
+	Tables t = {};
+	for (int x = 0; x < 256; x++) {
+		t.S[x] = sbox((std::uint8_t)x);
+		for (int i = 0; i < 8; i++) {
+			std::uint64_t row = 0;
+			for (int j = 0; j < 8; j++)
+				row = (row << 8) | gf_mul(t.S[x], H0[i ^ j]);
+			t.T[i][x] = row;
+		}
+	}
+	return t;
+}
+
+// a class template, so the tables are defined once over all the translation units (no C++17 inline variables):
+template <typename Unused = void>
+struct TableHolder {
+	static constexpr Tables value = make_tables();
+};
+template <typename Unused>
+constexpr Tables TableHolder<Unused>::value;
+
+inline const Tables &tables() {
+	return TableHolder<>::value;
+}
+
+static_assert(TableHolder<>::value.S[0x00] == 0xBA && TableHolder<>::value.S[0xFF] == 0x42,
+			  "S-box does not match the reference code");
+static_assert(TableHolder<>::value.T[0][0x00] == 0xbad3d268bbb96a01ULL,
+			  "T tables do not match the reference code");
+
+// one full round: gamma, theta and sigma[key]
+inline std::uint64_t round(std::uint64_t state, std::uint64_t key) {
+	const Tables &t = tables();
+	return
+		t.T[0][(state >> 56)       ] ^
+		t.T[1][(state >> 48) & 0xff] ^
+		t.T[2][(state >> 40) & 0xff] ^
+		t.T[3][(state >> 32) & 0xff] ^
+		t.T[4][(state >> 24) & 0xff] ^
+		t.T[5][(state >> 16) & 0xff] ^
+		t.T[6][(state >>  8) & 0xff] ^
+		t.T[7][(state      ) & 0xff] ^
+		key;
+}
+
+// the last round: gamma and sigma[key], from the byte S-box
+inline std::uint64_t last_round(std::uint64_t state, std::uint64_t key) {
+	const Tables &t = tables();
+	return
+		((std::uint64_t)t.S[(state >> 56)       ] << 56) ^
+		((std::uint64_t)t.S[(state >> 48) & 0xff] << 48) ^
+		((std::uint64_t)t.S[(state >> 40) & 0xff] << 40) ^
+		((std::uint64_t)t.S[(state >> 32) & 0xff] << 32) ^
+		((std::uint64_t)t.S[(state >> 24) & 0xff] << 24) ^
+		((std::uint64_t)t.S[(state >> 16) & 0xff] << 16) ^
+		((std::uint64_t)t.S[(state >>  8) & 0xff] <<  8) ^
+		((std::uint64_t)t.S[(state      ) & 0xff]      ) ^
+		key;
+}
+
+// theta only (for the decryption round keys): the S-box is an involution, so T[i][S[x]] = S[S[x]] * H = x * H
+inline std::uint64_t theta(std::uint64_t state) {
+	const Tables &t = tables();
+	std::uint64_t result = 0;
+	for (int i = 0; i < 8; i++)
+		result ^= t.T[i][t.S[(state >> (56 - 8*i)) & 0xff]];
+	return result;
+}
+
+// rounds First..Last-1, unrolled at compile time:
+template <int First, int Last>
+struct Rounds {
+	static inline std::uint64_t run(std::uint64_t state, const std::uint64_t *key) {
+		return Rounds<First + 1, Last>::run(round(state, key[First]), key);
+	}
+};
+template <int Last>
+struct Rounds<Last, Last> {
+	static inline std::uint64_t run(std::uint64_t state, const std::uint64_t *) {
+		return state;
+	}
+};
+
+inline std::uint64_t load(const std::uint8_t *in) {
+	return ((std::uint64_t)in[0] << 56) ^ ((std::uint64_t)in[1] << 48) ^
+		   ((std::uint64_t)in[2] << 40) ^ ((std::uint64_t)in[3] << 32) ^
+		   ((std::uint64_t)in[4] << 24) ^ ((std::uint64_t)in[5] << 16) ^
+		   ((std::uint64_t)in[6] <<  8) ^ ((std::uint64_t)in[7]      );
+}
+
+inline void store(std::uint8_t *out, std::uint64_t x) {
+	for (int i = 0; i < 8; i++)
+		out[i] = (std::uint8_t)(x >> (56 - 8*i));
+}
+
+} // namespace detail
+
+/**
+ * KHAZAD with a fixed direction and number of rounds.
+ *
+ * @tparam	D			encryption or decryption.
+ * @tparam	NumRounds	number of rounds (8 for KHAZAD; up to 31, limited by the round constants).
+ */
+template <Direction D, int NumRounds = 8>
+class Cipher {
+	static_assert(NumRounds >= 1 && NumRounds <= 31, "KHAZAD round constants are defined for 1..31 rounds");
+
+public:
+	/**
+	 * Compute the round keys of the direction D.
+	 *
+	 * @param	key		the 128-bit cipher key.
+	 */
+	explicit Cipher(const std::uint8_t key[KEY_BYTES]) {
+		const detail::Tables &t = detail::tables();
+		std::uint64_t k2 = detail::load(key), k1 = detail::load(key + 8), enc[NumRounds + 1];
+
+		// K^r = rho[c^r](K^{r-1}) ^ K^{r-2}:
+		for (int r = 0; r <= NumRounds; r++) {
+			enc[r] = detail::round(k1, detail::load(&t.S[8*r])) ^ k2;
+			k2 = k1;
+			k1 = enc[r];
+		}
+
+		if (D == Direction::Encrypt) {
+			for (int r = 0; r <= NumRounds; r++)
+				key_[r] = enc[r];
+		}
+		else {
+			// K'^0 = K^R, K'^R = K^0, K'^r = theta(K^{R-r}):
+			key_[0] = enc[NumRounds];
+			for (int r = 1; r < NumRounds; r++)
+				key_[r] = detail::theta(enc[NumRounds - r]);
+			key_[NumRounds] = enc[0];
+		}
+	}
+
+	/**
+	 * Process a data block given as a 64-bit big-endian value.
+	 */
+	std::uint64_t process(std::uint64_t block) const {
+		std::uint64_t state = block ^ key_[0];
+		state = detail::Rounds<1, NumRounds>::run(state, key_);
+		return detail::last_round(state, key_[NumRounds]);
+	}
+
+	/**
+	 * Process one 8-byte data block.
+	 *
+	 * @param	in		the input block.
+	 * @param	out		the output block (may be the same as in).
+	 */
+	void process(const std::uint8_t in[BLOCK_BYTES], std::uint8_t out[BLOCK_BYTES]) const {
+		detail::store(out, process(detail::load(in)));
+	}
+
+	/**
+	 * Process a buffer of data blocks (ECB), two independent blocks per iteration.
+	 *
+	 * @param	in		the input blocks.
+	 * @param	out		the output blocks (may be the same buffer as in).
+	 * @param	blocks	number of data blocks.
+	 */
+	void process(const std::uint8_t *in, std::uint8_t *out, std::size_t blocks) const {
+		std::size_t i = 0;
+		for (; i + 2 <= blocks; i += 2) {
+			std::uint64_t a = process(detail::load(in + BLOCK_BYTES*i));
+			std::uint64_t b = process(detail::load(in + BLOCK_BYTES*(i + 1)));
+			detail::store(out + BLOCK_BYTES*i, a);
+			detail::store(out + BLOCK_BYTES*(i + 1), b);
+		}
+		if (i < blocks)
+			process(in + BLOCK_BYTES*i, out + BLOCK_BYTES*i);
+	}
+
+private:
+	std::uint64_t key_[NumRounds + 1];
+};
+
+using Encryptor = Cipher<Direction::Encrypt>;
+using Decryptor = Cipher<Direction::Decrypt>;
+
+} // namespace khazad
+
+#endif   /* KHAZAD_HPP */
@@ -18,9 +18,14 @@ Input ctrl_from_PS[5:0] is received from the PS via AXI:
 	  When bits are equal, start_condition=0, and the PS will be notified that operation has ended.
 Input finish: a pulse from KHAZAD when last_round has ended.
 Output ctrl_to_PS: bistable output start/ready flag sent to the PS via EMIO to notify PS that operation has ended.
+Output done_IRQ: a 4-cycle pulse when an operation has ended, to the PS interrupt IRQ_F2P[0] (GIC ID 61, rising edge),
+so the PS may sleep (WFI) until the end of an operation instead of polling ctrl_to_PS.
+The packaged IP (controller_IP/component.xml) is still version 2.0, without the done_IRQ port: re-package it
+in Vivado (Tools > Create and Package IP, Merge changes from File Groups and Ports) before connecting done_IRQ
+to IRQ_F2P[0] in the block design, and build the software with HAL_DONE_IRQ only for that bitstream.
 *********************************************************************************************************
 *********************************************************************************************************
-Version 2.0: ECB+CBC implementation
+Version 3.0: ECB+CBC implementation, done interrupt
 *********************************************************************************************************
 *********************************************************************************************************/
 module controller
@@ -35,6 +40,7 @@ output   		   op_mode		   ,
 output   		   first_block	   ,
 output  		   start		   ,
 output  reg 	   ctrl_to_PS	   ,
+output  reg 	   done_IRQ		   ,
 output			   RST_LED		   ,
 output  		   PL_ready_LED	   ,
 output			   encryption_LED  ,
@@ -63,6 +69,26 @@ begin
 		ctrl_to_PS <= ctrl_from_PS[0]; // when bits are equal, start_condition=0, and PS notified that operation has ended
 end
 
+reg [1:0] IRQ_count;
+
+always @(posedge CLK)
+begin
+	if (RST)
+		begin
+			done_IRQ <= 0;
+			IRQ_count <= 0;
+		end
+	else if (finish) 				   // rises with ctrl_to_PS
+		begin
+			done_IRQ <= 1;
+			IRQ_count <= 3;
+		end
+	else if (IRQ_count)				   // the pulse is stretched, for the edge detection of the GIC
+		IRQ_count <= IRQ_count - 1;
+	else
+		done_IRQ <= 0;
+end
+
 always @(posedge CLK)
 begin
 	if (RST)
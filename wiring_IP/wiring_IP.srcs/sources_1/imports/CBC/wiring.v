@@ -12,6 +12,11 @@ It concatenates the four 32-bit key_in parts input into one 128-bit key for the
 the two 32-bit d_in parts input into one 64-bit d_in for the PL,
 the two 32-bit IV parts input into one 64-bit IV for the PL,
 and splits the 64-bit d_out output into two 32-bit d_out for the PS.
+In the version 2.0 block design (the bitstream in hw/) d_in_1, d_in_2 and d_out_1, d_out_2 are connected to the
+bidirectional (tri-state) AXI_GPIO_4, and the PS changes its direction twice for every data block.
+The ports are already separate, so a regenerated block design may connect d_in_1, d_in_2 to AXI_GPIO_4
+(All Outputs, 0x41240000) and d_out_1, d_out_2 to a new AXI_GPIO_5 (All Inputs, 0x41250000);
+the PS driver supports that register map with HAL_SPLIT_DATA (khazad-hal.h).
 *********************************************************************************************************
 *********************************************************************************************************
 Version 2.0: ECB+CBC implementation